@@ -24,6 +24,10 @@ namespace Hex
 		uint16_t height = 900;
 		bool fullscreen = false;
 		bool vsync = true;
+		bool texture_arrays = false;   // pack same-sized material maps into shared texture arrays, see TextureAtlas
+		uint16_t shadow_map_size = 4096; // per cascade; 32-bit depth, 4 layers live + 4 cached: 512 MB at 4096, 128 MB at 2048
+		bool headless = false;         // invisible window and no ImGui; renders `headless_frames` frames into the FrameBuffer, then exits
+		uint32_t headless_frames = 600;
 	};
 
 	class Application
@@ -0,0 +1,143 @@
+#pragma once
+
+// CPU frame profiler. Scopes are timed with HEX_PROFILE_SCOPE("name") on any thread; each thread records into
+// its own buffer without locking, and the main loop gathers them once per frame with HEX_PROFILE_FRAME().
+// In a PRODUCTION_BUILD every macro expands to nothing and none of this is compiled.
+
+#if !PRODUCTION_BUILD
+
+// STL
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Hex
+{
+	// One timed scope, as recorded by the thread it ran on
+	struct ProfileEvent
+	{
+		const char* name{nullptr}; // string literal; never copied
+		uint64_t begin_ns{0};      // since the profiler started
+		uint64_t end_ns{0};
+		uint32_t depth{0};         // scopes already open on the thread when this one began
+		uint32_t thread{0};        // index into Profiler::GetThreadNames
+	};
+
+	// Events of one thread. Only the owning thread writes; the collector reads up to `written` and copes
+	// with the writer lapping it by discarding what may have been overwritten.
+	struct ProfileThreadBuffer
+	{
+		static constexpr uint64_t k_capacity = 1u << 14; // events between two collections before the oldest are lost
+
+		std::array<ProfileEvent, k_capacity> events{};
+		std::atomic<uint64_t> written{0};
+		uint64_t collected{0};     // collector only
+		uint32_t depth{0};         // owner only
+		uint32_t index{0};
+
+		void Push(const ProfileEvent& event)
+		{
+			const uint64_t slot = written.load(std::memory_order_relaxed);
+			events[slot % k_capacity] = event;
+			written.store(slot + 1, std::memory_order_release);
+		}
+	};
+
+	class Profiler
+	{
+	public:
+		static constexpr size_t k_trace_capacity = 1u << 18; // most recent events kept for the Chrome trace
+
+		// Events gathered by the last BeginFrame, and the span between the two calls
+		struct Frame
+		{
+			uint64_t begin_ns{0};
+			uint64_t end_ns{0};
+			std::vector<ProfileEvent> events;
+		};
+
+		static Profiler& Get();
+
+		// Gathers every thread's finished events; call once at the top of the main loop
+		void BeginFrame();
+
+		[[nodiscard]] uint64_t Now() const;
+
+		// The calling thread's buffer, registered on first use
+		[[nodiscard]] ProfileThreadBuffer& ThisThread();
+		void SetThreadName(const char* name);
+
+		// Chrome trace-event JSON (chrome://tracing, Perfetto) of the last k_trace_capacity events
+		bool WriteChromeTrace(const std::string& path);
+
+		[[nodiscard]] const Frame& GetLastFrame() const { return m_last_frame; }
+		[[nodiscard]] std::vector<std::string> GetThreadNames();
+		[[nodiscard]] uint64_t GetLostEvents() const { return m_lost_events; }
+
+		bool paused{false};        // keep showing the same frame; events are still gathered for the trace
+
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+	private:
+		Profiler();
+
+		void Collect(ProfileThreadBuffer& buffer, std::vector<ProfileEvent>& out);
+
+		const uint64_t m_start_ns;
+
+		std::mutex m_threads_mutex; // registration and collection only, never taken while recording
+		std::vector<std::unique_ptr<ProfileThreadBuffer>> m_threads;
+		std::vector<std::string> m_thread_names;
+
+		uint64_t m_frame_begin_ns{0};
+		Frame m_last_frame;
+		std::vector<ProfileEvent> m_collected;
+		std::vector<ProfileEvent> m_trace; // ring of k_trace_capacity
+		size_t m_trace_next{0};
+		uint64_t m_lost_events{0};
+	};
+
+	// Times the enclosing block on the calling thread
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_buffer(Profiler::Get().ThisThread()), m_name(name), m_depth(m_buffer.depth++), m_begin_ns(Profiler::Get().Now())
+		{
+		}
+
+		~ProfileScope()
+		{
+			--m_buffer.depth;
+			m_buffer.Push({ m_name, m_begin_ns, Profiler::Get().Now(), m_depth, m_buffer.index });
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		ProfileThreadBuffer& m_buffer;
+		const char* m_name;
+		uint32_t m_depth;
+		uint64_t m_begin_ns;
+	};
+}
+
+#define HEX_PROFILE_CONCAT_INNER(a, b) a##b
+#define HEX_PROFILE_CONCAT(a, b) HEX_PROFILE_CONCAT_INNER(a, b)
+#define HEX_PROFILE_SCOPE(name) ::Hex::ProfileScope HEX_PROFILE_CONCAT(hex_profile_scope_, __LINE__)(name)
+#define HEX_PROFILE_FRAME() ::Hex::Profiler::Get().BeginFrame()
+#define HEX_PROFILE_THREAD(name) ::Hex::Profiler::Get().SetThreadName(name)
+
+#else
+
+#define HEX_PROFILE_SCOPE(name) ((void)0)
+#define HEX_PROFILE_FRAME() ((void)0)
+#define HEX_PROFILE_THREAD(name) ((void)0)
+
+#endif
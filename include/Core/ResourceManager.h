@@ -8,6 +8,10 @@
 #include <functional>
 #include <filesystem>
 #include <iostream>
+#include <vector>
+
+// Hex
+#include "Renderer/Data/GeometryPool.h"
 
 namespace Hex
 {
@@ -98,11 +102,12 @@ namespace Hex
 
         // --- Convenience loaders ---
 
-        // Load an Assimp Model by filepath (key == filepath)
-        static std::shared_ptr<Model> LoadModel(const std::string& filepath);
+        // Load an Assimp Model by filepath (key == filepath, plus "|compact" for compact vertices)
+        static std::shared_ptr<Model> LoadModel(const std::string& filepath, VertexFormat format = VertexFormat::Standard);
 
-        // Load one mesh (sub-mesh) from file. Key == filepath#meshIndex
-        static std::shared_ptr<Mesh> LoadMesh(const std::string& filepath, const unsigned int& meshIndex);
+        // Load one mesh (sub-mesh) from file. Key == filepath#meshIndex, plus "|compact" for compact vertices
+        static std::shared_ptr<Mesh> LoadMesh(const std::string& filepath, const unsigned int& meshIndex,
+                                              VertexFormat format = VertexFormat::Standard);
 
         static std::shared_ptr<Material> LoadMaterial(const std::string& vs,
             const std::string& fs, const std::string& albedoTex = "", const std::string& normalTex = "",
@@ -112,8 +117,9 @@ namespace Hex
         // Load an image file via stb_image into an OpenGL Texture, Key == filepath
         static std::shared_ptr<Texture> LoadTexture(const std::string& filepath, const bool& srgb = true);
 
-        // Load a Shader by two file paths. Key == vsPath + "|" + fsPath
-        static std::shared_ptr<Shader> LoadShader(const std::string& vsPath, const std::string& fsPath);
+        // Load a Shader by two file paths. Key == vsPath + "|" + fsPath, plus "|" + define for each define
+        static std::shared_ptr<Shader> LoadShader(const std::string& vsPath, const std::string& fsPath,
+            const std::vector<std::string>& defines = {});
 
     private:
         // Internal cache type
@@ -48,4 +48,22 @@ namespace Hex {
 		float rate{10.f};
 		glm::vec3 axis{0.f, 1.f, 0.f};
 	};
+
+	// Lights take their position from the entity's TransformComponent; spot lights point along its -Z
+	struct PointLightComponent
+	{
+		glm::vec3 color{1.f};
+		float intensity{1.f};
+		float range{5.f};        // no light past this distance
+		bool cast_shadows{false}; // cube shadow map, for the few nearest the camera
+	};
+
+	struct SpotLightComponent
+	{
+		glm::vec3 color{1.f};
+		float intensity{1.f};
+		float range{10.f};
+		float inner_angle{20.f}; // degrees from the axis, full intensity inside
+		float outer_angle{30.f}; // fades to nothing here
+	};
 }
\ No newline at end of file
@@ -57,6 +57,13 @@ namespace Hex
             return registry.get<Component>(entity);
         }
 
+        // Modify a component in place and notify on_update listeners (e.g. the renderer's render list).
+        // Prefer this over writing through GetComponent when the change should be seen by observers.
+        template<typename Component, typename... Func>
+        void PatchComponent(entt::entity entity, Func&&... func) {
+            registry.patch<Component>(entity, std::forward<Func>(func)...);
+        }
+
         // Check if an entity has a specific component
         template<typename Component>
         bool HasComponent(entt::entity entity) const {
@@ -3,6 +3,9 @@
 // Third-party
 #include <glm/glm.hpp>
 
+// Hex
+#include "Renderer/Data/Bounds.h"
+
 struct GLFWwindow;
 
 namespace Hex
@@ -22,6 +25,9 @@ namespace Hex
 		[[nodiscard]] const glm::mat4& GetViewMatrix();
 		[[nodiscard]] const glm::mat4& GetProjectionMatrix();
 
+		// World-space view frustum, from the current view and projection
+		[[nodiscard]] Frustum GetFrustum();
+
 		void ProcessKeyboardInput(GLFWwindow* window, const float& delta_time);
 		void ProcessMouseInput(double x_offset, double y_offset, const bool constrain_pitch = true);
 		void ProcessMouseScroll(const float& y_offset);
@@ -37,6 +43,10 @@ namespace Hex
 		[[nodiscard]] glm::vec3 GetForwardVector() const;
 		[[nodiscard]] glm::vec3 GetUpVector() const;
 		[[nodiscard]] glm::vec3 GetPosition() const;
+		[[nodiscard]] float GetFieldOfView() const { return m_zoom; }   // vertical, in degrees
+		[[nodiscard]] float GetAspectRatio() const { return m_aspect_ratio; }
+		[[nodiscard]] float GetNearPlane() const { return m_near_plane; }
+		[[nodiscard]] float GetFarPlane() const { return m_far_plane; }
 	private:
 		// Matrices
 		glm::mat4 m_view_matrix{};
@@ -52,6 +62,8 @@ namespace Hex
 		float m_pitch{};
 		float m_zoom{};
 		float m_aspect_ratio{};
+		float m_near_plane{0.1f};
+		float m_far_plane{10000.f};
 	
 		float m_movement_speed{5.f};
 		float m_mouse_sensitivity{0.1f};
@@ -0,0 +1,50 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Third-party
+#include <glm/glm.hpp>
+
+// Hex
+#include "Renderer/Data/Bounds.h"
+#include "Renderer/Data/Meshlet.h"
+
+namespace Hex
+{
+	// World-space AABBs stored as centre/extents in separate arrays, so the culling kernel can
+	// load four or eight boxes with one instruction per component
+	struct CullBounds
+	{
+		std::vector<float> center_x, center_y, center_z;
+		std::vector<float> extent_x, extent_y, extent_z;
+
+		[[nodiscard]] size_t Size() const { return center_x.size(); }
+
+		void Resize(size_t count);
+
+		// Transform an object-space box by `model` and store the enclosing world-space box at `slot`
+		void Set(size_t slot, const AABB& local, const glm::mat4& model);
+
+		// Add a copy of `source`'s box at `slot` to the end
+		void Append(const CullBounds& source, size_t slot);
+	};
+
+	// True if box `i` intersects the frustum; the scalar test FrustumCull runs on its tail
+	[[nodiscard]] bool IsVisible(const Frustum& frustum, const CullBounds& bounds, uint32_t i);
+
+	// Appends the index of every box in [first, first + count) that intersects the frustum to `visible`,
+	// in ascending order. Uses AVX2 (8 boxes per step) when the CPU has it, else SSE2 (4 per step).
+	void FrustumCull(const Frustum& frustum, const CullBounds& bounds, uint32_t first, uint32_t count,
+					 std::vector<uint32_t>& visible);
+
+	// Appends the index of every meshlet of one instance, drawn with `model`, whose sphere intersects the
+	// frustum and whose triangles do not all face away from `eye`. The normal cone is only trusted when
+	// `model` scales every axis alike and does not mirror; otherwise only the sphere is tested.
+	void MeshletCull(const Frustum& frustum, const glm::vec3& eye, const glm::mat4& model,
+					 const std::vector<Meshlet>& meshlets, std::vector<uint32_t>& visible);
+
+	// Name of the instruction set FrustumCull picked on this CPU, for the metrics panel
+	[[nodiscard]] const char* GetCullingInstructionSet();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// STL
+#include <array>
+
+// Third-party
+#include <glm/glm.hpp>
+
+namespace Hex
+{
+    struct AABB
+    {
+        glm::vec3 min{0.0f};
+        glm::vec3 max{0.0f};
+
+        [[nodiscard]] glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+        [[nodiscard]] glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+    };
+
+    struct BoundingSphere
+    {
+        glm::vec3 center{0.0f};
+        float radius{0.0f};
+    };
+
+    // Object-space bounds of a mesh, computed once at load time
+    struct MeshBounds
+    {
+        AABB box{};
+        BoundingSphere sphere{};
+    };
+
+    // Six planes (xyz = inward normal, w = distance) in the order left, right, bottom, top, near, far
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> planes{};
+
+        // Gribb/Hartmann extraction from a view-projection matrix; planes come out in the matrix's input space
+        static Frustum FromMatrix(const glm::mat4& view_projection);
+    };
+}
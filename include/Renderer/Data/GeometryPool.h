@@ -0,0 +1,142 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+// Third-party
+#include <glad/glad.h>
+
+namespace Hex
+{
+    // How a mesh stores its vertices in the pool: full floats (Vertex), or quantised (CompactVertex)
+    enum class VertexFormat : uint8_t
+    {
+        Standard = 0,
+        Compact = 1,
+    };
+    static constexpr uint32_t k_vertex_format_count = 2;
+
+    // How a mesh stores its indices: 16 bits whenever its vertex count allows
+    enum class IndexType : uint8_t
+    {
+        UInt32 = 0,
+        UInt16 = 1,
+    };
+    static constexpr uint32_t k_index_type_count = 2;
+
+    // Vertex format and index type together; each pair has its own VAO, and a multi-draw never mixes them
+    static constexpr uint32_t k_geometry_layout_count = k_vertex_format_count * k_index_type_count;
+
+    [[nodiscard]] constexpr uint32_t GetGeometryLayout(const VertexFormat format, const IndexType index_type)
+    {
+        return static_cast<uint32_t>(format) * k_index_type_count + static_cast<uint32_t>(index_type);
+    }
+
+    // Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;           // index count
+        GLuint instance_count;
+        GLuint first_index;     // offset into the pool's index buffer of the draw's index type, in indices
+        GLint  base_vertex;     // offset into the pool's vertex buffer, in vertices
+        GLuint base_instance;   // offset into the instance binding, in instances
+    };
+
+    // All mesh vertices and indices share a handful of large buffers: one vertex buffer per vertex format,
+    // one index buffer per index type, and a VAO for each pairing of the two (a geometry layout).
+    // Draws of different meshes in the same layout never need a VAO/VBO/EBO rebind.
+    class GeometryPool
+    {
+    public:
+        // A mesh's slice of the shared buffers
+        struct Allocation
+        {
+            VertexFormat format{VertexFormat::Standard};
+            IndexType index_type{IndexType::UInt32};
+            GLint   base_vertex{0};     // in the format's vertex buffer
+            GLuint  vertex_count{0};
+            GLuint  first_index{0};     // in the index type's index buffer
+            GLsizei index_count{0};
+
+            [[nodiscard]] uint32_t GetLayout() const { return GetGeometryLayout(format, index_type); }
+        };
+
+        // Created once the GL context exists, destroyed before it goes away
+        static void Init();
+        static void Shutdown();
+        [[nodiscard]] static GeometryPool* Get() { return s_instance.get(); }
+
+        // Capacities are per stream, for the buffer each one creates on its first allocation
+        GeometryPool(GLuint vertex_capacity, GLuint index_capacity);
+        ~GeometryPool();
+
+        GeometryPool(const GeometryPool&) = delete;
+        GeometryPool(GeometryPool&&) = delete;
+
+        GeometryPool& operator=(const GeometryPool&) = delete;
+        GeometryPool& operator=(GeometryPool&&) = delete;
+
+        // Upload a mesh into the pool, growing the buffers if needed. `vertices` are Vertex or CompactVertex, per `format`.
+        // With IndexType::UInt16 the indices are narrowed on the way in, so they must all be below 65536.
+        Allocation Allocate(VertexFormat format, const void* vertices, GLuint vertex_count,
+                            IndexType index_type, const uint32_t* indices, GLsizei index_count);
+        void Free(const Allocation& allocation);
+
+        // Binds the layout's VAO (see GetGeometryLayout). Instance data is read from whatever is bound to Mesh::k_instance_binding.
+        void Bind(uint32_t layout = 0) const;
+
+        [[nodiscard]] static GLsizei GetVertexStride(VertexFormat format);
+        [[nodiscard]] static GLsizei GetIndexSize(IndexType index_type);
+        // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, for draws through the layout's VAO
+        [[nodiscard]] static GLenum GetIndexGLType(uint32_t layout);
+
+        [[nodiscard]] GLuint GetVAO(uint32_t layout = 0) const { return m_vaos[layout]; }
+        [[nodiscard]] GLuint GetVertexCount(VertexFormat format) const { return VertexStreamOf(format).used; }
+        [[nodiscard]] GLuint GetVertexCapacity(VertexFormat format) const { return VertexStreamOf(format).range.capacity; }
+        [[nodiscard]] GLuint GetIndexCount(IndexType index_type) const { return IndexStreamOf(index_type).used; }
+        [[nodiscard]] GLuint GetIndexCapacity(IndexType index_type) const { return IndexStreamOf(index_type).range.capacity; }
+
+    private:
+        // First-fit free list over a range of elements
+        struct RangeAllocator
+        {
+            GLuint capacity{0};
+            std::map<GLuint, GLuint> free_blocks; // offset -> size
+
+            bool Allocate(GLuint size, GLuint& offset);
+            void Free(GLuint offset, GLuint size);
+            void Grow(GLuint new_capacity);
+        };
+
+        // One vertex or index buffer and its allocator, in elements. The buffer stays 0 until the first allocation.
+        struct Stream
+        {
+            GLuint buffer{0};
+            RangeAllocator range;
+            GLuint used{0};
+            GLuint initial_capacity{0}; // size of the buffer the first allocation creates
+        };
+
+        [[nodiscard]] Stream& VertexStreamOf(VertexFormat format) { return m_vertex_streams[static_cast<size_t>(format)]; }
+        [[nodiscard]] const Stream& VertexStreamOf(VertexFormat format) const { return m_vertex_streams[static_cast<size_t>(format)]; }
+        [[nodiscard]] Stream& IndexStreamOf(IndexType index_type) { return m_index_streams[static_cast<size_t>(index_type)]; }
+        [[nodiscard]] const Stream& IndexStreamOf(IndexType index_type) const { return m_index_streams[static_cast<size_t>(index_type)]; }
+
+        // Finds room for `count` elements, creating or growing the buffer (and rebinding it in every VAO) if needed
+        GLuint AllocateElements(Stream& stream, GLuint count, GLsizeiptr element_size, const char* name);
+        static void GrowStream(Stream& stream, GLuint min_capacity, GLsizeiptr element_size, const char* name);
+        void RebindStreams() const;
+        void SetupVertexArray(uint32_t layout) const;
+
+        static GLuint CreateBuffer(GLsizeiptr size);
+
+        std::array<Stream, k_vertex_format_count> m_vertex_streams{};
+        std::array<Stream, k_index_type_count> m_index_streams{};
+        std::array<GLuint, k_geometry_layout_count> m_vaos{};
+
+        static std::unique_ptr<GeometryPool> s_instance;
+    };
+}
@@ -9,11 +9,32 @@
 // Hex
 #include "Renderer/Shader.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 
 namespace Hex
 {
+    // std140 mirror of the MaterialData block in debug.frag
+    struct alignas(16) MaterialData
+    {
+        int has_albedo_map{0};
+        int has_normal_map{0};
+        int has_roughness_map{0};
+        int has_metallic_map{0};
+        int has_ao_map{0};
+        int padding[3]{};   // std140 rounds the block up to 16 bytes
+    };
+
     class Material {
     public:
+        // Uniform block binding of MaterialData; texture units are fixed by layout(binding) in the shader
+        static constexpr GLuint k_parameter_binding = 1;
+
+        Material() = default;
+        ~Material();
+
+        Material(const Material&) = delete;
+        Material& operator=(const Material&) = delete;
+
         // optional texture maps
         std::shared_ptr<Texture>  albedo_map, normal_map, roughness_map, metallic_map, ao_map;
 
@@ -22,8 +43,29 @@ namespace Hex
 
         bool cull_backfaces = true;
 
-        // set all uniforms and bind textures
+        // True if the atlas exists and every map this material has was copied into it;
+        // such a material must use the MATERIAL_ATLAS variant of its shader
+        bool CanUseAtlas() const;
+
+        // Upload the parameter block, or register with the atlas; call once the maps and shader are assigned
+        void CreateParameterBlock();
+
+        // bind the parameter block and textures
         void Apply() const;
 
+        // Materials with the same key can go in one multi-draw: the atlas binding they share, or the material itself
+        const void* GetBatchKey() const {
+            return m_atlas_binding ? static_cast<const void*>(m_atlas_binding) : static_cast<const void*>(this);
+        }
+        bool UsesAtlas() const { return m_atlas_binding != nullptr; }
+        // Index of this material's layers in the atlas record buffer, carried per instance
+        uint32_t GetAtlasRecord() const { return m_atlas_record; }
+
+    private:
+        const Texture* GetMap(size_t slot) const;
+
+        GLuint m_parameter_buffer = 0;
+        const TextureAtlas::Binding* m_atlas_binding = nullptr;
+        uint32_t m_atlas_record = 0;
     };
 }
@@ -1,12 +1,19 @@
 ﻿#pragma once
 
 // STL
+#include <cstdint>
 #include <vector>
 
 // Third-party
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 
+// Hex
+#include "Renderer/Data/Bounds.h"
+#include "Renderer/Data/GeometryPool.h"
+#include "Renderer/Data/Meshlet.h"
+#include "Renderer/Data/RenderStructs.h"
+
 namespace Hex {
     struct Vertex {
         glm::vec3 pos, normal;
@@ -14,21 +21,75 @@ namespace Hex {
         glm::vec4 tangent;
     };
 
+    // Vertex::tangent and friends squeezed into 20 bytes instead of 48 (VertexFormat::Compact)
+    struct CompactVertex {
+        uint16_t pos[4];     // xyz quantised against the mesh's bounding box; w is the bitangent sign, 0 for -1
+        int16_t normal[2];   // octahedral, snorm
+        int16_t tangent[2];  // octahedral, snorm
+        uint16_t uv[2];      // half floats
+    };
+    static_assert(sizeof(CompactVertex) == 20);
+
+    // How shaders turn a proxy's vertices back into object space; matches VertexDecode in the vertex shaders
+    struct VertexDecode {
+        glm::vec3 offset{0.0f};
+        float compact{0.0f};     // 1 when normal and tangent are octahedral
+        glm::vec3 scale{1.0f};
+        float padding{0.0f};
+    };
+
+    // One level of detail: a run of the mesh's indices, all into the same vertices
+    struct MeshLod {
+        GLuint first_index{0};  // in the pool's index buffer
+        GLsizei index_count{0};
+    };
+
+    // Geometry lives in the shared GeometryPool; a Mesh only remembers its slice of it
     class Mesh {
     public:
-        Mesh(std::vector<Vertex>&& verts, std::vector<uint32_t>&& idx);
+        // `lodIndices` are the coarser levels, LOD 1 first; they share `verts` and go into the same pool allocation.
+        // `meshletList` splits LOD 0 (see BuildMeshlets), with index ranges relative to `idx`.
+        // With VertexFormat::Compact the vertices are quantised against `meshBounds` before upload.
+        Mesh(std::vector<Vertex>&& verts, std::vector<uint32_t>&& idx, const MeshBounds& meshBounds,
+             const std::vector<std::vector<uint32_t>>& lodIndices = {}, std::vector<Meshlet>&& meshletList = {},
+             VertexFormat format = VertexFormat::Standard);
         ~Mesh();
 
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
         void Draw() const;
 
-        // Instanced draw: draws 'instanceCount' copies, each using the
-        // per-instance mat4 attributes
-        void DrawInstanced(GLsizei instanceCount) const;
+        // Instanced draw: draws 'instanceCount' copies, each reading its
+        // instance table index starting at 'baseInstance' in the buffer
+        // bound to k_instance_binding
+        void DrawInstanced(GLsizei instanceCount, GLuint baseInstance = 0) const;
+
+        // Indirect command drawing this mesh out of the pool, for glMultiDrawElementsIndirect
+        [[nodiscard]] DrawElementsIndirectCommand MakeDrawCommand(GLuint instanceCount, GLuint baseInstance, uint32_t lod = 0) const;
+
+        // Draws one meshlet of LOD 0
+        [[nodiscard]] DrawElementsIndirectCommand MakeMeshletCommand(GLuint instanceCount, GLuint baseInstance, uint32_t meshlet) const;
+
+        [[nodiscard]] uint32_t GetLodCount() const { return static_cast<uint32_t>(lods.size()); }
+
+        [[nodiscard]] VertexFormat GetVertexFormat() const { return geometry.format; }
+        [[nodiscard]] IndexType GetIndexType() const { return geometry.index_type; }
+        [[nodiscard]] uint32_t GetGeometryLayout() const { return geometry.GetLayout(); }
+        [[nodiscard]] const VertexDecode& GetVertexDecode() const { return decode; }
+
+        // Vertex buffer binding indices: per-vertex data, and the per-instance
+        // indices into the renderer's instance table (streamed through its upload ring)
+        static constexpr GLuint k_vertex_binding = 0;
+        static constexpr GLuint k_instance_binding = 1;
 
-        GLuint VAO=0, VBO=0, EBO=0;
-        GLsizei indexCount=0;
-        GLuint instanceVBO = 0;
+        GeometryPool::Allocation geometry{};
+        GLsizei indexCount=0;      // LOD 0
+        MeshBounds bounds{};
+        std::vector<MeshLod> lods; // LOD 0 is the full mesh; never more than k_max_mesh_lods
+        std::vector<Meshlet> meshlets; // clusters of LOD 0, index ranges in the pool; empty for small meshes
     private:
+        VertexDecode decode{};
 
     };
 }
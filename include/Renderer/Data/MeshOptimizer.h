@@ -0,0 +1,30 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Hex
+{
+    struct Vertex;
+
+    // FIFO post-transform cache size the reordering targets and ACMR is measured with
+    static constexpr uint32_t k_vertex_cache_size = 16;
+
+    // Average cache miss ratio: vertices shaded per triangle with a FIFO cache of `cache_size` entries.
+    // 3 is the worst case; a large regular grid can approach 0.5.
+    [[nodiscard]] float ComputeAcmr(const uint32_t* indices, size_t index_count, uint32_t cache_size = k_vertex_cache_size);
+
+    // Tipsify (Sander, Nehab, Barczak 2007) orders triangles so consecutive ones reuse vertices still in
+    // the cache, then the clusters it leaves behind are sorted so the ones facing out of the mesh draw
+    // first and hide what is behind them. Winding is kept. Splits clusters only where that costs at
+    // most `acmr_threshold` times the cache-optimised ACMR. Returns the number of clusters.
+    size_t OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float acmr_threshold = 1.05f);
+
+    // Renumbers vertices in the order the indices first use them, so fetches walk the vertex buffer
+    // forwards. `lod_indices` index the same vertices and are renumbered along with `indices`;
+    // vertices none of them use are dropped.
+    void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                             std::vector<std::vector<uint32_t>>& lod_indices);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+namespace Hex
+{
+    struct Vertex;
+
+    // Quadric error metric (Garland-Heckbert) simplification by half-edge collapse. Vertices are only ever
+    // merged into a neighbour, never moved or created, so the result indexes the same vertex buffer.
+    // Vertices on open borders or UV/normal seams stay put. Stops at `target_index_count` indices, or
+    // earlier if nothing else can collapse without flipping a triangle.
+    [[nodiscard]] std::vector<uint32_t> SimplifyMesh(const std::vector<Vertex>& vertices,
+                                                     const std::vector<uint32_t>& indices,
+                                                     size_t target_index_count);
+
+    // Index buffers for LOD 1 and up, each simplified from the one before to about half its triangles.
+    // Stops once a level has too few triangles, or would not shrink enough to be worth drawing.
+    [[nodiscard]] std::vector<std::vector<uint32_t>> BuildLodChain(const std::vector<Vertex>& vertices,
+                                                                   const std::vector<uint32_t>& indices,
+                                                                   size_t max_levels);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Third-party
+#include <glm/glm.hpp>
+
+namespace Hex
+{
+    struct Vertex;
+
+    // Meshlet limits: small enough that a cluster is a useful unit to cull, large enough to keep draws cheap
+    static constexpr uint32_t k_meshlet_max_vertices = 64;
+    static constexpr uint32_t k_meshlet_max_triangles = 124;
+
+    // A run of a mesh's LOD 0 triangles that sit close together, with what is needed to cull it on its own
+    struct Meshlet
+    {
+        uint32_t first_index{0};      // relative to LOD 0 until the Mesh rebases it into the pool
+        uint32_t index_count{0};
+        glm::vec3 center{0.0f};       // object-space bounding sphere
+        float radius{0.0f};
+        glm::vec3 cone_axis{0.0f};    // average facing of the triangles
+        float cone_cutoff{-1.0f};     // cos of the widest angle between a triangle normal and the axis; <= 0 never back-faces
+    };
+
+    // Groups triangles into meshlets by growing each one across shared vertices, and reorders `indices`
+    // so every meshlet is a contiguous run. Meshes that fit in one meshlet get none: there is nothing to split.
+    // Normal cones are only kept for closed meshes; the colour pass doesn't cull back faces, so an open
+    // mesh's back-facing clusters are still visible.
+    [[nodiscard]] std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+}
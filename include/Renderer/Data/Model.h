@@ -20,9 +20,9 @@ namespace Hex
     class Model
     {
     public:
-        // Loads all sub-meshes from `path` into the shared ResourceManager cache.
+        // Loads all sub-meshes from `path` into the shared ResourceManager cache, with vertices in `format`.
         // Throws std::runtime_error if the file fails to load.
-        Model(const std::string& path);
+        Model(const std::string& path, VertexFormat format = VertexFormat::Standard);
 
         // Draws all the sub-meshes in this model.
         void Draw() const;
@@ -1,9 +1,18 @@
 #pragma once
 
+// STL
+#include <array>
+#include <cstdint>
+#include <vector>
+
 // Third-party
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 
+// Hex
+#include "Renderer/Data/Bounds.h"
+#include "Renderer/Data/GeometryPool.h"
+
 namespace Hex
 {
 	// Forward declarations
@@ -11,8 +20,21 @@ namespace Hex
 	class Camera;
 	class Shader;
 	class Mesh;
+	class RingBuffer;
+	class GpuProfiler;
+	class RenderList;
+	class Material;
 	struct ScreenQuad;
 
+	// Upper bound on cascades; must match MAX_CASCADES in debug.vert, debug.frag and cull.comp
+	static constexpr int k_max_shadow_cascades = 4;
+
+	// Point lights that get a cube shadow map, nearest to the camera first
+	static constexpr uint32_t k_max_point_shadows = 4;
+
+	// Upper bound on levels of detail per mesh, LOD 0 included
+	static constexpr uint32_t k_max_mesh_lods = 4;
+
 	struct alignas(16) RenderData
 	{
 		glm::mat4 view;           // 64 bytes (16-byte alignment)
@@ -30,6 +52,18 @@ namespace Hex
 		bool      wireframe;      // 4 bytes (std140 bool→int)
 		float     padding4[3];    // 12 bytes (to align struct size to 16)
 
+		glm::vec4 frustum_planes[6];                            // camera frustum (xyz = inward normal, w = distance)
+		glm::vec4 cascade_planes[k_max_shadow_cascades * 6];    // caster frustum of each shadow cascade
+
+		glm::mat4 light_space_matrices[k_max_shadow_cascades];  // world -> shadow map, per cascade
+		glm::vec4 cascade_splits;                               // view-space distance each cascade ends at
+		int       cascade_count;                                // 0 = no shadows this frame
+		int       padding5[3];
+
+		glm::uvec3 cluster_grid;      // LightGrid tiles x, tiles y, depth slices
+		uint32_t   padding6;
+		glm::vec4  cluster_params;    // tiles per pixel x / y, slice scale, slice bias
+
 		bool operator==(const RenderData& other) const = default;
 	};
 
@@ -40,20 +74,162 @@ namespace Hex
 		glm::mat4      modelMatrix;
 	};
 
+	// Per-frame submission counters, reset at the start of every Tick
+	struct RenderStats
+	{
+		uint32_t draw_calls{0};       // glMultiDrawElementsIndirect calls issued
+		uint32_t draw_commands{0};    // indirect commands consumed by those calls
+		uint32_t instances{0};        // instances submitted across all passes
+		uint32_t proxies_resorted{0}; // render proxies (re)inserted into the sorted list
+		uint32_t transforms_updated{0};
+		float    extract_ms{0.f};     // CPU time spent in the scene extraction stage
+		uint64_t instance_bytes{0};   // instance + command bytes uploaded by the extraction stage
+		uint32_t visible{0};          // proxies inside the camera frustum
+		uint32_t culled{0};           // outside the camera frustum
+		uint32_t occluded{0};         // inside the frustum but hidden behind last frame's depth
+		uint32_t shadow_visible{0};   // caster instances drawn, summed over cascades
+		uint32_t shadow_cascades_static{0}; // cascades whose cached static depth was re-rendered
+		uint32_t shadow_cascades_cached{0}; // cascades left untouched
+		float    shadow_ms{0.f};      // CPU time spent encoding the cascade pass
+		uint32_t shadow_culled{0};    // caster instances culled, summed over cascades
+		std::array<uint32_t, k_max_mesh_lods> lod_proxies{}; // proxies at each LOD after selection, visible or not
+		uint32_t meshlets_visible{0}; // meshlets drawn for LOD 0 camera instances
+		uint32_t meshlets_culled{0};  // outside the frustum or facing away
+		uint32_t lights{0};           // point + spot lights gathered this frame
+		uint32_t light_clusters{0};   // clusters with at least one light
+		uint32_t light_assignments{0};// entries in the cluster light index list
+		uint32_t max_cluster_lights{0};
+		float    light_assign_ms{0.f};// CPU time spent gathering and clustering lights
+		uint32_t point_shadow_faces_static{0};  // cube faces whose static casters were re-rendered
+		uint32_t point_shadow_faces_dynamic{0}; // cube faces rebuilt from the static cache plus dynamic casters
+		uint32_t point_shadow_faces_cached{0};  // cube faces left untouched
+	};
+
+	// GPU-resident buffer only ever written through staged copies
+	struct GpuBuffer
+	{
+		GLuint buffer{0};
+		uint32_t capacity{0};   // in elements
+		uint32_t count{0};      // elements in use
+	};
+
+	// Indirect commands that can be drawn with one multi-draw, because they share a material
+	struct DrawBucket
+	{
+		Material* material{nullptr};
+		uint32_t first_command{0};
+		uint32_t command_count{0};
+		uint32_t instance_count{0};
+		uint32_t layout{0};                          // GetGeometryLayout; buckets never mix layouts
+	};
+
+	// Slice of the shared command buffer one pass submits
+	struct PassDraws
+	{
+		uint32_t first_command{0};
+		uint32_t command_count{0};
+		uint32_t instance_count{0};
+		std::array<uint32_t, k_geometry_layout_count> layout_commands{}; // commands per geometry layout, in that order
+	};
+
+	// Output of the per-frame scene extraction. Instances are uploaded once and every view's
+	// visible instance indices + commands live in one ring allocation; passes only reference them by offset.
+	struct ScenePacket
+	{
+		uint32_t instance_count{0};
+		GLuint index_buffer{0};                // per-instance indices into the instance table, for every view
+		GLuint command_buffer{0};              // indirect commands for every view
+		GLintptr command_offset{0};            // byte offset of the first command in command_buffer
+		std::array<PassDraws, k_max_shadow_cascades> shadow_cascades{}; // casters inside each cascade, material or not; only dynamic ones when caching
+		std::array<PassDraws, k_max_shadow_cascades> shadow_static{};   // static casters of cascades whose cached depth is redrawn
+		std::vector<DrawBucket> opaque;        // visible proxies with a material, one bucket per material
+	};
+
 	struct ShadowMap
 	{
 		GLuint fbo{0};         // Framebuffer for shadow mapping
-		GLuint texture{0};     // Texture to store the depth information
-		glm::mat4 light_view{glm::mat4(1.f)};          // View matrix for the light
-		glm::mat4 light_projection{glm::mat4(1.f)};    // Projection matrix for the light
-		int shadow_width{4096}, shadow_height{4096};
+		GLuint texture{0};     // GL_TEXTURE_2D_ARRAY with one depth layer per cascade
+		std::array<GLuint, k_max_shadow_cascades> layer_views{};  // GL_TEXTURE_2D views of each layer, for the debug UI
+		std::array<glm::mat4, k_max_shadow_cascades> light_view{};         // View matrix for the light, per cascade
+		std::array<glm::mat4, k_max_shadow_cascades> light_projection{};   // Projection matrix for the light, per cascade
+		std::array<float, k_max_shadow_cascades> split_depths{};          // view-space distance each cascade ends at
+		std::array<Frustum, k_max_shadow_cascades> caster_frustums{};     // light frustum minus its near plane, for culling
+		int cascade_count{1};
+		int shadow_width{4096}, shadow_height{4096};   // per cascade layer, from AppSpecification::shadow_map_size
+
+		// Shadow caching: static casters are kept in their own array, redrawn only when a cascade's light
+		// matrix changes or a static caster moves; each frame `texture` is that plus the dynamic casters.
+		// Bit per cascade.
+		GLuint static_fbo{0};
+		GLuint static_texture{0};
+		std::array<glm::mat4, k_max_shadow_cascades> static_matrices{}; // light matrix each cached layer was drawn with
+		uint8_t static_valid{0};
+		uint8_t dynamic_cascades{0};   // had dynamic casters drawn over the cached depth last frame
+
+		// This frame's work
+		uint8_t static_redraw{0};
+		uint8_t live_redraw{0};
+	};
+
+	// One shadowed point light's cube in PointShadowMaps. Face bits follow the cube map face order +X -X +Y -Y +Z -Z.
+	struct PointShadowSlot
+	{
+		uint32_t light{~0u};           // entt::to_integral of the light entity, ~0u when free
+		glm::vec3 position{0.0f};
+		float range{0.0f};
+		std::array<glm::mat4, 6> face_matrices{};
+		std::array<Frustum, 6> face_frustums{};
+		uint8_t static_valid{0};       // faces whose static caster depth is current
+		uint8_t dynamic_faces{0};      // faces that had dynamic casters drawn over them last frame
+
+		// This frame's work
+		uint8_t static_redraw{0};
+		uint8_t live_redraw{0};
+		PassDraws static_casters{};
+		PassDraws dynamic_casters{};
+	};
+
+	// Cube depth maps (distance to the light / range) for shadowed point lights. Static casters are kept
+	// in their own array and only redrawn when the light or one of them moves; the sampled array is
+	// that copied face by face with dynamic casters drawn on top.
+	struct PointShadowMaps
+	{
+		GLuint fbo{0};                 // layered: every face of `texture`
+		GLuint static_fbo{0};          // layered: every face of `static_texture`
+		GLuint texture{0};             // GL_TEXTURE_CUBE_MAP_ARRAY, one cube per slot
+		GLuint static_texture{0};
+		int size{512};
+		std::array<PointShadowSlot, k_max_point_shadows> slots{};
 	};
 
 	struct FrameBuffer
 	{
 		GLuint frame_buffer{0};
 		GLuint texture{0};
-		GLuint depth_render_buffer{0};
-		unsigned int render_width{100}, render_height{100};
+		GLuint depth_texture{0};  // depth-stencil texture, so the Hi-Z pyramid can be built from it
+		unsigned int width{100}, height{100};               // allocated size: the viewport panel
+		unsigned int render_width{100}, render_height{100}; // sub-rectangle from (0, 0) the scene renders into this frame
+	};
+
+	// Scales the scene's render size so the GPU frame time holds at a target; the panel shows the
+	// rendered sub-rectangle stretched back up with bilinear filtering
+	struct DynamicResolution
+	{
+		bool enabled{false};
+		float target_ms{16.6f};   // GPU time of shadow + scene passes to aim for
+		float min_scale{0.5f};    // per axis
+		float scale{1.0f};        // per axis, applied to the panel size
+		float response{0.05f};    // fraction of the way to the ideal scale taken per frame
+	};
+
+	// Max-depth mip pyramid of the previous frame's depth buffer, used for occlusion culling
+	struct HiZBuffer
+	{
+		GLuint texture{0};            // GL_R32F, texel = furthest depth of the area it covers
+		int width{0}, height{0};
+		int view_width{0}, view_height{0}; // part of level 0 the camera rendered into (dynamic resolution)
+		int levels{0};
+		glm::mat4 view_projection{1.0f}; // camera the pyramid was rendered with
+		bool valid{false};            // false until a frame has been built at the current size
 	};
 }
\ No newline at end of file
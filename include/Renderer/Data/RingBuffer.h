@@ -0,0 +1,85 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Third-party
+#include <glad/glad.h>
+
+namespace Hex
+{
+    // Per-frame upload counters, reset at the start of every frame
+    struct RingBufferStats
+    {
+        uint64_t bytes_uploaded{0};     // bytes written into the ring this frame
+        uint32_t stalls_avoided{0};     // frame region was already free when we got to it
+        uint32_t stalls{0};             // had to block on the GPU before reusing a region
+        uint32_t reallocations{0};      // ring grew at the start of this frame
+        uint32_t overflows{0};          // allocations that did not fit and went to a one-off buffer
+    };
+
+    // Persistently mapped, fence synchronised upload ring (glBufferStorage + GL_MAP_PERSISTENT_BIT).
+    // The buffer is split into one region per frame in flight; the CPU writes straight into
+    // the current region while the GPU is still reading the previous ones.
+    class RingBuffer
+    {
+    public:
+        static constexpr uint32_t k_frames_in_flight = 3;
+
+        struct Allocation
+        {
+            void* data{nullptr};   // mapped pointer to write into
+            GLintptr offset{0};    // byte offset from the start of `buffer`
+            GLuint buffer{0};      // the ring, or a one-off overflow buffer
+        };
+
+        explicit RingBuffer(GLsizeiptr frame_capacity);
+        ~RingBuffer();
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer(RingBuffer&&) = delete;
+
+        RingBuffer& operator=(const RingBuffer&) = delete;
+        RingBuffer& operator=(RingBuffer&&) = delete;
+
+        // Move to the next frame region, waiting on its fence if the GPU is still using it.
+        // If the last frame overflowed, the ring is regrown here, before any name is handed out.
+        void BeginFrame();
+
+        // Fence the current region once every draw reading from it has been submitted
+        void EndFrame();
+
+        // Reserve `size` bytes in the current frame region. The returned offset is a multiple of
+        // `alignment`, so offset / stride can be used directly as a base instance.
+        // If the frame has run out of space the allocation comes from a one-off buffer instead, so
+        // always bind Allocation::buffer; names handed out earlier in the frame never change.
+        Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 256);
+
+        [[nodiscard]] GLuint GetID() const { return m_buffer; }
+        [[nodiscard]] GLsizeiptr GetFrameCapacity() const { return m_frame_capacity; }
+        [[nodiscard]] const RingBufferStats& GetStats() const { return m_stats; }
+
+    private:
+        void CreateStorage(GLsizeiptr frame_capacity);
+        void DestroyStorage();
+        Allocation AllocateOverflow(GLsizeiptr size);
+        static GLuint CreateMappedBuffer(GLsizeiptr size, uint8_t*& mapped);
+
+        GLuint m_buffer{0};
+        uint8_t* m_mapped{nullptr};
+
+        GLsizeiptr m_frame_capacity{0};
+        GLsizeiptr m_head{0};            // write cursor inside the current region
+        uint32_t m_frame_index{0};
+
+        std::array<GLsync, k_frames_in_flight> m_fences{};
+
+        // Overflow buffers of each frame region, deleted once its fence has signalled
+        std::array<std::vector<GLuint>, k_frames_in_flight> m_overflow{};
+        GLsizeiptr m_overflow_bytes{0};  // overflowed this frame; the next BeginFrame grows the ring to fit
+
+        RingBufferStats m_stats{};
+    };
+}
@@ -3,6 +3,9 @@
 // Third-party
 #include <glad/glad.h>
 
+// Hex
+#include "Renderer/GLState.h"
+
 namespace Hex
 {
 
@@ -37,7 +40,7 @@ namespace Hex
 			glGenVertexArrays(1, &vao);
 			glGenBuffers(1, &vbo);
 
-			glBindVertexArray(vao);
+			GLState::BindVertexArray(vao);
 
 			glBindBuffer(GL_ARRAY_BUFFER, vbo);
 			glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertices), quad_vertices, GL_STATIC_DRAW);
@@ -51,7 +54,7 @@ namespace Hex
 			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			glBindVertexArray(0);
+			GLState::BindVertexArray(0);
 
 		};
   	};
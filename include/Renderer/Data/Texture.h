@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+// STL
+#include <cstdint>
+
 // Third-party
 #include <glad/glad.h>
 
@@ -25,8 +28,8 @@ namespace Hex {
         void Bind(GLuint unit = 0) const;
 
         static void InitDefaults();
-        static void BindWhite();
-        static void BindDefaultNormal();
+        static void BindWhite(GLuint unit = 0);
+        static void BindDefaultNormal(GLuint unit = 0);
 
         // Unbinds any texture from that unit/target
         static void Unbind(GLuint unit = 0);
@@ -39,8 +42,16 @@ namespace Hex {
         // Returns the underlying GL handle
         GLuint GetID() const { return m_id; }
 
+        // Page and layer of the copy TextureAtlas made, if any
+        void SetAtlasSlot(uint32_t page, uint32_t layer) { m_atlas_page = page; m_atlas_layer = layer; }
+        bool IsAtlased() const { return m_atlas_page != ~0u; }
+        uint32_t GetAtlasPage() const { return m_atlas_page; }
+        uint32_t GetAtlasLayer() const { return m_atlas_layer; }
+
     private:
         GLuint m_id = 0;
+        uint32_t m_atlas_page = ~0u;
+        uint32_t m_atlas_layer = 0;
     };
 
 } // namespace Hex
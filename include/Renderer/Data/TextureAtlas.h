@@ -0,0 +1,107 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Third-party
+#include <glad/glad.h>
+
+namespace Hex
+{
+    class Shader;
+    class Texture;
+
+    // Material maps in Material::Apply order: albedo, normal, roughness, metallic, ao
+    static constexpr size_t k_material_map_count = 5;
+
+    // std430 mirror of MaterialRecord in debug.frag: one array layer per map, -1 where the material has none
+    struct MaterialRecord
+    {
+        std::array<int32_t, 8> layers{ -1, -1, -1, -1, -1, -1, -1, -1 };   // two ivec4s, last three unused
+    };
+
+    // Material maps grouped into GL_TEXTURE_2D_ARRAY pages by size and format. Materials whose maps all
+    // made it into a page stop binding textures of their own: materials sharing a shader and pages share
+    // one set of binds, so the renderer can put them in the same multi-draw, and each instance looks its
+    // layers up through a material record index.
+    class TextureAtlas
+    {
+    public:
+        static constexpr uint32_t k_no_page = ~0u;
+        static constexpr GLuint k_material_records_binding = 7;   // SSBO binding of the records in debug.frag
+
+        // What a group of atlased materials binds; materials with equal bindings can be drawn together
+        struct Binding
+        {
+            Shader* shader{nullptr};
+            std::array<uint32_t, k_material_map_count> pages{};
+            bool cull_backfaces{true};
+
+            bool operator==(const Binding&) const = default;
+        };
+
+        // Created once the GL context exists, destroyed before it goes away
+        static void Init();
+        static void Shutdown();
+        [[nodiscard]] static TextureAtlas* Get() { return s_instance.get(); }
+
+        TextureAtlas();
+        ~TextureAtlas();
+
+        TextureAtlas(const TextureAtlas&) = delete;
+        TextureAtlas(TextureAtlas&&) = delete;
+
+        TextureAtlas& operator=(const TextureAtlas&) = delete;
+        TextureAtlas& operator=(TextureAtlas&&) = delete;
+
+        // Copy every mip of a complete 2D texture into a free layer of a page with the same size and
+        // format, and record the layer on the texture. False if the page ran into the layer limit.
+        bool Add(Texture& texture, GLenum internal_format, int width, int height);
+
+        // Register a material's layers; the returned index is what its instances carry
+        uint32_t AddMaterial(const MaterialRecord& record);
+
+        // Interned, so materials compare bindings by pointer
+        const Binding* InternBinding(const Binding& binding);
+
+        // Pages onto texture units 0..4, matching the sampler2DArray bindings of the atlas shader variant
+        void Bind(const Binding& binding) const;
+
+        // Upload new material records and bind them on k_material_records_binding
+        void BindMaterialRecords();
+
+        [[nodiscard]] size_t GetPageCount() const { return m_pages.size(); }
+        [[nodiscard]] uint32_t GetLayerCount() const;
+        [[nodiscard]] size_t GetMaterialCount() const { return m_records.size(); }
+
+    private:
+        struct Page
+        {
+            GLuint texture{0};
+            GLenum format{0};
+            int width{0};
+            int height{0};
+            int levels{0};
+            uint32_t layer_count{0};
+            uint32_t capacity{0};
+        };
+
+        void GrowPage(Page& page, uint32_t capacity) const;
+
+        std::vector<Page> m_pages;
+        GLint m_max_layers{0};
+
+        std::vector<MaterialRecord> m_records;
+        GLuint m_record_buffer{0};
+        size_t m_record_capacity{0};
+        bool m_records_dirty{false};
+
+        std::deque<Binding> m_bindings;   // stable addresses for InternBinding
+
+        static std::unique_ptr<TextureAtlas> s_instance;
+    };
+}
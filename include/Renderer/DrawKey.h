@@ -0,0 +1,70 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Hex
+{
+	// Draw sort key, most significant field first, so sorting by the key orders by geometry layout, pass, then state cost:
+	//   layout:2 | pass:1 | shader:8 | group:10 | material:12 | mesh:15 | depth:16
+	// Layout (vertex format and index type) goes first so any view's commands split into one run per
+	// layout, each drawn through its own VAO with its own index type.
+	// `group` is what a multi-draw bucket binds (Material::GetBatchKey), so materials that can share one
+	// stay together under their shader. Depth is zero in the render list and filled in per view.
+	enum class DrawPass : uint8_t
+	{
+		Opaque = 0,
+		Shadow = 1,
+	};
+
+	namespace DrawKey
+	{
+		inline constexpr uint32_t k_shader_bits = 8;
+		inline constexpr uint32_t k_group_bits = 10;
+		inline constexpr uint32_t k_material_bits = 12;
+		inline constexpr uint32_t k_mesh_bits = 15;
+		inline constexpr uint32_t k_depth_bits = 16;
+
+		[[nodiscard]] uint64_t Pack(uint32_t layout, DrawPass pass, uint32_t shader, uint32_t group, uint32_t material,
+								   uint32_t mesh, uint32_t depth = 0);
+
+		// Per-view key for instances that already sit in draw order: the ordinal of their batch
+		// above the depth, so sorting moves instances within a batch but never across batches
+		[[nodiscard]] inline uint64_t PackInstance(const uint32_t batch, const uint32_t depth)
+		{
+			return (static_cast<uint64_t>(batch) << 32) | depth;
+		}
+
+		// Log-spaced view depth in [near, far], so nearby objects get most of the precision
+		[[nodiscard]] uint32_t QuantiseDepth(float view_depth, float near_plane, float far_plane);
+	}
+
+	// Hands out small IDs in first-seen order, so keys do not depend on where objects sit in memory.
+	// Null is always 0. Once the field is full every further object shares the last ID, which only
+	// costs batching, never correctness: batches are still split by pointer.
+	class DrawKeyIds
+	{
+	public:
+		explicit DrawKeyIds(uint32_t bits) : m_limit((1u << bits) - 1) {}
+
+		[[nodiscard]] uint32_t Get(const void* object);
+
+	private:
+		std::unordered_map<const void*, uint32_t> m_ids;
+		uint32_t m_limit;
+		bool m_warned{false};
+	};
+
+	// A key and the index of whatever it was built for
+	struct SortItem
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	// Stable LSD radix sort by key, 8 bits per pass. Passes over bytes every key shares are skipped,
+	// which for draw keys is most of them. `scratch` is resized as needed and can be reused across calls.
+	void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Third-party
+#include <glad/glad.h>
+
+namespace Hex
+{
+	// Calls made through GLState since the last ResetStats(): the ones that reached GL and the redundant ones dropped
+	struct GLStateStats
+	{
+		uint32_t state_issued{0};
+		uint32_t state_skipped{0};
+		uint32_t uniforms_issued{0};
+		uint32_t uniforms_skipped{0};
+	};
+
+	// Shadow copy of the GL state the renderer changes most: program, texture units, VAO, framebuffers,
+	// viewport and raster state. Every setter compares against the shadow and only calls GL on a change,
+	// so passes and materials can set what they need without caring what the previous draw left bound.
+	// Code that changes this state behind its back (ImGui, other contexts) must be followed by Invalidate().
+	class GLState
+	{
+	public:
+		static void UseProgram(GLuint program);
+		static void BindVertexArray(GLuint vao);
+		static void BindFramebuffer(GLenum target, GLuint framebuffer);
+		static void ActiveTexture(GLuint unit);
+		static void BindTexture(GLuint unit, GLenum target, GLuint texture);
+		// Binds on whichever unit is active, for texture setup code
+		static void BindTexture(GLenum target, GLuint texture);
+		static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+		static void BindUniformBuffer(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+		static void SetEnabled(GLenum capability, bool enabled);
+		static void CullFace(GLenum mode);
+		static void DepthFunc(GLenum func);
+		static void DepthMask(bool write);
+		static void ColorMask(bool write);
+
+		// False if `program` already holds `value` at `location`; uniforms live in the program, so this survives rebinds
+		[[nodiscard]] static bool UniformChanged(GLuint program, GLint location, const void* value, size_t size);
+
+		// GL unbinds deleted objects everywhere; the shadow has to follow or a recycled name would be skipped
+		static void ForgetTexture(GLuint texture);
+		static void ForgetFramebuffer(GLuint framebuffer);
+		static void ForgetBuffer(GLuint buffer);
+
+		// Mark everything unknown, so the next call of each setter reaches GL
+		static void Invalidate();
+
+		static void ResetStats() { s_stats = {}; }
+		[[nodiscard]] static const GLStateStats& GetStats() { return s_stats; }
+
+	private:
+		static constexpr GLuint k_unknown = ~0u;
+		static constexpr size_t k_texture_units = 16;
+		static constexpr size_t k_texture_targets = 4;   // 2D, 2D array, cube, cube array
+		static constexpr size_t k_capabilities = 6;      // see CapabilityIndex
+		static constexpr size_t k_uniform_buffer_bindings = 8;
+		static constexpr size_t k_max_uniform_size = sizeof(float) * 16;
+
+		static int TargetIndex(GLenum target);
+		static int CapabilityIndex(GLenum capability);
+		static bool Changed(GLuint& current, GLuint value);
+
+		static GLuint s_program;
+		static GLuint s_vao;
+		static GLuint s_draw_framebuffer;
+		static GLuint s_read_framebuffer;
+		static GLuint s_active_unit;
+		static std::array<std::array<GLuint, k_texture_targets>, k_texture_units> s_textures;
+		struct BufferRange
+		{
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+
+			bool operator==(const BufferRange&) const = default;
+		};
+
+		static std::array<GLint, 4> s_viewport;
+		static std::array<BufferRange, k_uniform_buffer_bindings> s_uniform_buffers;
+		static std::array<GLuint, k_capabilities> s_capabilities;   // 0/1, or k_unknown
+		static GLuint s_cull_face;
+		static GLuint s_depth_func;
+		static GLuint s_depth_mask;
+		static GLuint s_color_mask;
+		static std::unordered_map<uint64_t, std::array<std::byte, k_max_uniform_size>> s_uniforms;
+		static GLStateStats s_stats;
+	};
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Third-party
+#include <glad/glad.h>
+
+namespace Hex
+{
+	// GPU time per named zone (render pass), from GL_TIMESTAMP queries around each one. A frame's queries are
+	// read back k_latency frames later, and only once all of them have come back; a frame still pending by
+	// then is dropped rather than waited on. Zones nest, and a name used more than once in a frame sums.
+	class GpuProfiler
+	{
+	public:
+		static constexpr uint32_t k_latency = 4;         // frames between issuing a zone and reading it
+		static constexpr uint32_t k_max_zones = 32;      // zones per frame; further ones are not timed
+		static constexpr uint32_t k_history = 240;       // resolved frames kept for averages, maxima and the CSV
+
+		struct Zone
+		{
+			std::string name;
+			uint32_t depth{0};                           // nesting level when first seen
+			std::array<float, k_history> history{};      // ms per resolved frame, < 0 where the zone didn't run
+			float last_ms{0.0f};
+			float average_ms{0.0f};                      // over the frames in history it ran in
+			float max_ms{0.0f};
+		};
+
+		// Times the enclosing block
+		class Scope
+		{
+		public:
+			Scope(GpuProfiler& profiler, const char* name) : m_profiler(profiler), m_zone(profiler.BeginZone(name)) {}
+			~Scope() { m_profiler.EndZone(m_zone); }
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			GpuProfiler& m_profiler;
+			uint32_t m_zone;
+		};
+
+		GpuProfiler();
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler(GpuProfiler&&) = delete;
+
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+		// Resolves the frame issued k_latency frames ago, if it is done, and starts recording a new one
+		void BeginFrame();
+
+		// Returns a handle for EndZone. Zones are matched by name, so keep names stable from frame to frame.
+		uint32_t BeginZone(const char* name);
+		void EndZone(uint32_t handle);
+
+		// Latest resolved time of the zone, 0 if it has none
+		[[nodiscard]] float GetLastMilliseconds(const char* name) const;
+		// Zones in the order they were first seen
+		[[nodiscard]] const std::vector<Zone>& GetZones() const { return m_zones; }
+		[[nodiscard]] uint32_t GetDroppedFrames() const { return m_dropped_frames; }
+
+		// One row per resolved frame in history, one column per zone; returns false if the file can't be written
+		bool WriteCsv(const std::string& path) const;
+
+	private:
+		struct Frame
+		{
+			std::array<GLuint, k_max_zones * 2> queries{}; // begin, end timestamp per zone
+			std::array<uint32_t, k_max_zones> zones{};     // index into m_zones
+			uint32_t count{0};
+			bool issued{false};
+		};
+
+		[[nodiscard]] uint32_t FindZone(const char* name);
+		void Resolve(Frame& frame);
+
+		std::array<Frame, k_latency> m_frames{};
+		uint32_t m_frame_index{0};
+		uint32_t m_depth{0};
+		std::vector<Zone> m_zones;
+		uint64_t m_resolved_frames{0};
+		uint32_t m_dropped_frames{0};
+	};
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Third-party
+#include <glm/glm.hpp>
+
+namespace Hex
+{
+	// One point or spot light as debug.frag reads it (std430). Points use spot_scale 0, spot_offset 1,
+	// so the cone term saturate(dot(-L, direction) * scale + offset) is always 1 for them.
+	struct GpuLight
+	{
+		glm::vec3 position;   // world space
+		float     range;      // falls off to exactly 0 here
+		glm::vec3 color;      // colour * intensity
+		float     spot_scale; // 1 / (cos inner - cos outer)
+		glm::vec3 direction;  // where a spot light points, world space
+		float     spot_offset;// -cos outer * spot_scale
+		int32_t   shadow_index;// cube in PointShadowMaps, -1 for none
+		float     padding[3]{};
+	};
+
+	// Froxel grid over the camera frustum: screen tiles in x/y, logarithmic depth slices in z.
+	// Each frame every light's bounding sphere is tested against the view-space box of the clusters
+	// it could touch, and the result is flattened into (offset, count) per cluster plus one light index list.
+	class LightGrid
+	{
+	public:
+		static constexpr uint32_t k_tiles_x = 16;
+		static constexpr uint32_t k_tiles_y = 9;
+		static constexpr uint32_t k_slices = 24;
+		static constexpr uint32_t k_cluster_count = k_tiles_x * k_tiles_y * k_slices;
+
+		// Rebuilds the cluster boxes when the projection changed. Slices are spread logarithmically
+		// from `near_plane` to `grid_far`; the last slice reaches on to `far_plane` so nothing is missed.
+		void SetProjection(float fov_y_degrees, float aspect_ratio, float near_plane, float far_plane, float grid_far);
+
+		// Assigns every light to the clusters its sphere touches
+		void Assign(const std::vector<GpuLight>& lights, const glm::mat4& view);
+
+		// debug.frag maps view depth d to floor(log(d) * scale + bias)
+		[[nodiscard]] float GetSliceScale() const { return m_slice_scale; }
+		[[nodiscard]] float GetSliceBias() const { return m_slice_bias; }
+
+		[[nodiscard]] const std::vector<glm::uvec2>& GetClusters() const { return m_clusters; } // offset, count
+		[[nodiscard]] const std::vector<uint32_t>& GetLightIndices() const { return m_light_indices; }
+		[[nodiscard]] uint32_t GetActiveClusters() const { return m_active_clusters; }
+		[[nodiscard]] uint32_t GetMaxClusterLights() const { return m_max_cluster_lights; }
+
+	private:
+		// Appends (cluster, light) for every cluster of row [first, first + count) the sphere touches
+		void TestRow(uint32_t first, uint32_t count, const glm::vec3& center, float radius, uint32_t light);
+
+		// Cluster boxes in view space with depth as positive z, one array per component so rows of
+		// tiles can be tested four at a time
+		std::vector<float> m_min_x, m_min_y, m_min_z;
+		std::vector<float> m_max_x, m_max_y, m_max_z;
+		std::vector<float> m_slice_depths;   // k_slices + 1 boundaries
+		glm::vec2 m_tan_half_fov{0.0f};      // x, y
+		glm::vec4 m_projection_key{0.0f};
+		float m_grid_far{0.0f};
+		float m_slice_scale{0.0f};
+		float m_slice_bias{0.0f};
+
+		std::vector<glm::uvec2> m_pairs;     // cluster, light
+		std::vector<glm::uvec2> m_clusters;
+		std::vector<uint32_t> m_light_indices;
+		uint32_t m_active_clusters{0};
+		uint32_t m_max_cluster_lights{0};
+	};
+}
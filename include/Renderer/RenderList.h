@@ -0,0 +1,159 @@
+#pragma once
+
+// STL
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Third-party
+#include <glm/glm.hpp>
+#include <entt/entt.hpp>
+
+// Hex
+#include "Renderer/Culling.h"
+#include "Renderer/DrawKey.h"
+#include "Renderer/Data/RenderStructs.h"
+
+namespace Hex
+{
+	class Material;
+	class Mesh;
+
+	// One drawable: a mesh drawn with a material at an entity's transform
+	struct RenderProxy
+	{
+		entt::entity entity{entt::null};
+		Material* material{nullptr};   // null for shadow-only casters without a MaterialComponent
+		Mesh* mesh{nullptr};
+	};
+
+	// A run of proxies sharing material + mesh, i.e. one indirect draw command
+	struct RenderBatch
+	{
+		Material* material{nullptr};
+		Mesh* mesh{nullptr};
+		uint32_t first{0};
+		uint32_t count{0};
+	};
+
+	// Contiguous range of instances whose transforms changed since the last Update()
+	struct InstanceRange
+	{
+		uint32_t first{0};
+		uint32_t count{0};
+	};
+
+	// Inputs to RenderList::SelectLods, taken from the camera each frame
+	struct LodSelection
+	{
+		glm::vec3 eye{0.0f};
+		float projection_scale{1.0f};   // 1 / tan(fov_y / 2): turns radius / distance into a share of the screen height
+		std::array<float, k_max_mesh_lods> screen_sizes{ 1.0f, 0.3f, 0.12f, 0.05f }; // LOD i is used once the bounds cover less than this; [0] is unused
+		float hysteresis{0.15f};        // relative band around each threshold, so instances sitting on one don't flicker
+		bool enabled{true};             // off: everything stays at LOD 0
+	};
+
+	// Persistent, sorted list of everything drawable in the registry. Kept up to date through
+	// on_construct/on_update/on_destroy signals instead of being rebuilt from views every frame,
+	// so a static scene costs next to nothing. Transform edits must go through registry.patch()
+	// (see EntityManager::PatchComponent) for the list to see them.
+	class RenderList
+	{
+	public:
+		explicit RenderList(entt::registry& registry);
+		~RenderList();
+
+		RenderList(const RenderList&) = delete;
+		RenderList(RenderList&&) = delete;
+
+		RenderList& operator=(const RenderList&) = delete;
+		RenderList& operator=(RenderList&&) = delete;
+
+		// Fold the changes recorded since the last call into the list
+		void Update();
+
+		// Proxies and their model matrices, sorted by draw key: shader, batch key (Material::GetBatchKey), material, mesh
+		[[nodiscard]] const std::vector<RenderProxy>& GetProxies() const { return m_proxies; }
+		[[nodiscard]] const std::vector<glm::mat4>& GetTransforms() const { return m_transforms; }
+		[[nodiscard]] const std::vector<RenderBatch>& GetBatches() const { return m_batches; }
+		// World-space bounds per proxy, kept in step with the transforms
+		[[nodiscard]] const CullBounds& GetWorldBounds() const { return m_world_bounds; }
+		// Level of detail per proxy, as last picked by SelectLods; moves with its proxy when the list is re-sorted
+		[[nodiscard]] const std::vector<uint8_t>& GetLods() const { return m_lods; }
+		// 1 for proxies whose transform has changed since they were added. Cached shadow depth only holds
+		// the others (static casters); dynamic ones are drawn over it every frame.
+		[[nodiscard]] const std::vector<uint8_t>& GetDynamic() const { return m_dynamic; }
+		// World boxes from before and after the move of every static proxy that moved in the last Update(),
+		// and so turned dynamic. Cached static depth overlapping any of them is stale. After a rebuild
+		// (WasRebuilt) all of it is.
+		[[nodiscard]] const CullBounds& GetMovedStaticBounds() const { return m_moved_static_bounds; }
+
+		// Re-pick every proxy's LOD from the screen size of its world bounds, moving at most across the
+		// hysteresis band of each threshold. Returns the slots whose LOD changed (count 0 if none did).
+		InstanceRange SelectLods(const LodSelection& selection);
+		// World boxes of the static proxies whose LOD the last SelectLods() changed. Casters are drawn at
+		// their current LOD, so cached static depth overlapping any of these holds the old silhouette.
+		[[nodiscard]] const CullBounds& GetLodChangedStaticBounds() const { return m_lod_changed_static_bounds; }
+		[[nodiscard]] const std::array<uint32_t, k_max_mesh_lods>& GetLodCounts() const { return m_lod_counts; }
+
+		// True if the last Update() added or removed proxies
+		[[nodiscard]] bool WasRebuilt() const { return m_rebuilt; }
+		// Every slot from here on holds a different proxy than before the last Update(); the slots ahead of
+		// the first removal or insertion kept theirs. The proxy count when nothing moved.
+		[[nodiscard]] uint32_t GetFirstMovedSlot() const { return m_first_moved_slot; }
+		// Transform ranges touched by the last Update(), all ahead of GetFirstMovedSlot()
+		[[nodiscard]] const std::vector<InstanceRange>& GetDirtyRanges() const { return m_dirty_ranges; }
+		// Bumped every time the order changes, so cached draw commands know to rebuild
+		[[nodiscard]] uint64_t GetVersion() const { return m_version; }
+
+		[[nodiscard]] uint32_t GetResortedCount() const { return m_resorted_count; }
+		[[nodiscard]] uint32_t GetUpdatedTransformCount() const { return m_updated_transform_count; }
+
+	private:
+		// Mesh/model/material added, swapped or removed: the entity's proxies are rebuilt
+		void OnDrawableChanged(entt::registry& registry, entt::entity entity);
+		// Only the model matrix changed: the proxies stay where they are
+		void OnTransformChanged(entt::registry& registry, entt::entity entity);
+
+		void ApplyStructuralChanges();
+		void ApplyTransformChanges();
+		void RebuildLookups();
+		uint64_t MakeSortKey(const RenderProxy& proxy);
+
+		entt::registry& m_registry;
+
+		std::vector<RenderProxy> m_proxies;
+		std::vector<glm::mat4> m_transforms;
+		std::vector<uint64_t> m_sort_keys;
+		CullBounds m_world_bounds;
+		std::vector<uint8_t> m_lods;
+		std::vector<uint8_t> m_dynamic;
+		CullBounds m_moved_static_bounds;
+		CullBounds m_lod_changed_static_bounds;
+		std::array<uint32_t, k_max_mesh_lods> m_lod_counts{};
+		std::vector<RenderBatch> m_batches;
+		std::unordered_map<entt::entity, std::vector<uint32_t>> m_entity_slots;
+
+		// Entities recorded by the signal handlers, deduplicated in Update()
+		std::vector<entt::entity> m_structure_dirty;
+		std::vector<entt::entity> m_transform_dirty;
+
+		// Small first-seen IDs for the key fields, and radix sort buffers
+		DrawKeyIds m_shader_ids{DrawKey::k_shader_bits};
+		DrawKeyIds m_group_ids{DrawKey::k_group_bits};
+		DrawKeyIds m_material_ids{DrawKey::k_material_bits};
+		DrawKeyIds m_mesh_ids{DrawKey::k_mesh_bits};
+		std::vector<SortItem> m_sort_items;
+		std::vector<SortItem> m_sort_scratch;
+
+		std::vector<uint32_t> m_dirty_slots;
+		std::vector<InstanceRange> m_dirty_ranges;
+		bool m_rebuilt{false};
+		uint32_t m_first_moved_slot{0};
+		uint64_t m_version{0};
+
+		uint32_t m_resorted_count{0};
+		uint32_t m_updated_transform_count{0};
+	};
+}
@@ -8,9 +8,14 @@
 
 //STL
 #include <memory>
+#include <vector>
 
 //Hex
 #include "Data/RenderStructs.h"
+#include "Data/GeometryPool.h"
+#include "DrawKey.h"
+#include "LightGrid.h"
+#include "RenderList.h"
 
 struct GLFWwindow;
 
@@ -48,17 +53,45 @@ namespace Hex
 
         // Buffers
         void InitShadowMap();
+        void InitPointShadowMaps();
         void InitFrameBuffer(const int& width, const int& height);
+        void InitHiZBuffer(int width, int height);
         void BindFrameBuffer() const;
         void BindWindowBuffer() const;
 
         // Rendering
         void RenderFullScreenQuad() const;
         void RenderScene() const;
-        void RenderSceneBatched() const;
+        void RenderSceneBatched();
+        void RenderDepthPrepass();
+        [[nodiscard]] bool UsesDepthPrepass() const { return m_depth_prepass && !m_wireframe_mode; }
         void RenderShadowMap();
+        void RenderPointShadows();
+        void DrawShadowCasters(const PassDraws& casters, GLintptr command_offset);
+        void UpdateShadowCascades();
+        void UpdateShadowCache();
+        void BuildHiZBuffer();
 
         void UpdateRenderData();
+        void UpdateDynamicResolution();
+        void UpdateLights();
+        void AssignPointShadows();
+        void UpdatePointShadows();
+
+        // Scene extraction, shared by every pass of the frame
+        void ExtractScene();
+        void SelectLods();
+        void UploadInstances();
+        void CullOnCpu();
+        void CullOnGpu();
+        void SortFrontToBack(std::vector<uint32_t>& visible);
+        PassDraws AppendViewDraws(const std::vector<uint32_t>& visible, bool lit_only);
+        void AppendMeshletDraws(const RenderBatch& batch, uint32_t first_index, PassDraws& pass);
+        void BindSceneBuffers() const { BindSceneBuffers(m_scene.index_buffer, m_scene.command_buffer); }
+        void BindSceneBuffers(GLuint index_buffer, GLuint command_buffer) const;
+        bool UploadViewDraws(GLuint& buffer, GLintptr& command_offset);
+        static bool EnsureCapacity(GpuBuffer& buffer, uint32_t count, GLsizeiptr stride);
+        void StageUpload(GLuint destination, GLintptr offset, const void* data, GLsizeiptr size);
 
         void SetLightDir(const glm::vec3& dir);
 
@@ -66,10 +99,14 @@ namespace Hex
         static void StartImGuiFrame();
         void EndImGuiFrame(const float& delta_time);
         void ShowDebugUI(const float& delta_time);
+#if !PRODUCTION_BUILD
+        void ShowCpuProfiler();
+#endif
 
         // Define a unique_ptr with a custom deleter type alias
         using GLFWwindowPtr = std::unique_ptr<GLFWwindow, void(*)(GLFWwindow*)>;
         GLFWwindowPtr m_window;
+        bool m_headless{false};         // invisible window, no ImGui, see AppSpecification::headless
 
         // Access to the application console
         std::shared_ptr<Console> m_console{nullptr};
@@ -79,25 +116,139 @@ namespace Hex
         std::unique_ptr<Camera> m_camera{nullptr};
         RenderData m_render_data{};
         RenderData m_old_render_data{};
+        RenderStats m_render_stats{};
 
         // Buffers
         FrameBuffer m_frame_buffer{};
+        DynamicResolution m_dynamic_resolution{};
         ShadowMap m_shadow_map{};
+        static constexpr GLuint k_shadow_map_unit = 5;   // layout(binding) of shadow_map in debug.frag
         std::unique_ptr<ScreenQuad> m_screen_quad{nullptr};
         GLuint m_uboRenderData = 0;
 
+        // GPU time per render pass, read back a few frames late
+        std::unique_ptr<GpuProfiler> m_gpu_profiler{nullptr};
+
+        // Persistently mapped ring every per-frame upload is staged through
+        static constexpr GLsizeiptr k_upload_ring_size = 256 * 1024;
+        std::unique_ptr<RingBuffer> m_upload_ring{nullptr};
+
+        // Incrementally maintained drawables, mirrored into GPU-resident buffers
+        std::unique_ptr<RenderList> m_render_list{nullptr};
+        static constexpr GLuint k_instance_table_binding = 0; // SSBO binding the shaders read models from
+        GpuBuffer m_instance_table{};      // one mat4 per render proxy, in render list order
+        static constexpr GLuint k_instance_materials_binding = 6; // SSBO of atlas material records per proxy
+        GpuBuffer m_instance_materials{};  // only used with a TextureAtlas
+        uint64_t m_instance_materials_version{~0ull};
+        static constexpr GLuint k_instance_decode_binding = 1; // SSBO of VertexDecode per proxy; the cull pass uses 1 for bounds
+        GpuBuffer m_instance_decode{};
+        uint64_t m_instance_decode_version{~0ull};
+        ScenePacket m_scene{};
+
+        Frustum m_camera_frustum{};
+
+        // GPU culling: bounds + batch ids per proxy in, per-view commands + visible indices out
+        static constexpr uint32_t k_max_cull_views = 1 + k_max_shadow_cascades;
+        static constexpr GLuint k_cull_group_size = 64;        // local_size_x in cull.comp
+        static constexpr GLuint k_cull_bounds_binding = 1;
+        static constexpr GLuint k_cull_batches_binding = 2;
+        static constexpr GLuint k_cull_commands_binding = 3;
+        static constexpr GLuint k_cull_visible_binding = 4;
+        static constexpr GLuint k_cull_counters_binding = 5;
+        static constexpr GLuint k_cull_lods_binding = 6;       // free during culling; the colour pass rebinds 6 itself
+        static constexpr uint32_t k_cull_counter_stride = k_max_cull_views + 1; // visible per view, then occluded
+        bool m_gpu_culling{false};
+        bool m_gpu_bounds_current{false};
+        GpuBuffer m_instance_bounds{};
+        GpuBuffer m_instance_batches{};    // first command of each proxy's batch, within a view
+        GpuBuffer m_instance_lods{};       // RenderList::GetLods(), four per uint
+        GpuBuffer m_gpu_command_template{};
+        GpuBuffer m_gpu_commands{};
+        GpuBuffer m_gpu_visible{};
+        GLuint m_cull_counters{0};
+        uint32_t* m_cull_counters_mapped{nullptr};
+        uint32_t m_cull_frame{0};
+        uint64_t m_gpu_cull_version{~0ull};
+        uint32_t m_gpu_cull_views{0};
+        uint32_t m_gpu_view_commands{0};   // one per LOD of every batch
+
+        // Occlusion culling against the previous frame's depth, done in cull.comp for the camera view
+        static constexpr GLuint k_hiz_texture_unit = 7;
+        bool m_occlusion_culling{true};
+        HiZBuffer m_hiz{};
+
+        // Distance LODs, picked per proxy from its projected size before any view is culled
+        LodSelection m_lod_selection{};
+        InstanceRange m_lod_changes{};
+
+        // Per-frame culling scratch, kept around to avoid reallocating
+        std::vector<uint32_t> m_camera_visible;
+        std::vector<uint32_t> m_shadow_visible;
+        std::vector<uint32_t> m_static_casters;  // m_shadow_visible split by RenderList::GetDynamic
+        std::vector<uint32_t> m_dynamic_casters;
+        std::vector<uint32_t> m_view_indices;
+        std::vector<DrawElementsIndirectCommand> m_view_commands;
+        std::vector<glm::vec4> m_bounds_scratch;
+        std::vector<SortItem> m_depth_sort_items;
+        std::vector<SortItem> m_depth_sort_scratch;
+        std::vector<uint32_t> m_meshlet_instances;
+        std::vector<uint32_t> m_meshlet_visible;
+        std::vector<uint32_t> m_meshlet_offsets;
+        std::vector<std::pair<uint32_t, uint32_t>> m_meshlet_pairs; // (meshlet, slot)
+
         //Lighting
         glm::vec3 m_light_dir{glm::normalize(glm::vec3(1.f, -1.f, -1.f))};
         glm::vec3 m_light_color{1.0f, 0.95f, 0.95f};
 
+        // Clustered point and spot lights, gathered from the registry and assigned to the LightGrid every frame
+        static constexpr GLuint k_lights_binding = 2;          // free in the draw passes; cull.comp uses 2..5 before them
+        static constexpr GLuint k_light_clusters_binding = 3;
+        static constexpr GLuint k_light_indices_binding = 4;
+        LightGrid m_light_grid{};
+        float m_light_grid_far{200.f};     // depth the logarithmic slices stop at; the last slice covers the rest
+        std::vector<GpuLight> m_lights;
+        GpuBuffer m_light_buffer{};
+        GpuBuffer m_light_cluster_buffer{};
+        GpuBuffer m_light_index_buffer{};
+        uint32_t m_point_light_count{0};
+        uint32_t m_spot_light_count{0};
+
+        // Cube shadows for the point lights nearest the camera that ask for them
+        struct ShadowCandidate
+        {
+            float distance2;     // to the camera
+            uint32_t light;      // index into m_lights
+            uint32_t entity;     // entt::to_integral
+        };
+        static constexpr GLuint k_point_shadow_unit = 6; // layout(binding) of point_shadow_maps in debug.frag
+        static constexpr float k_point_shadow_near = 0.05f;
+        bool m_point_shadows_enabled{true};
+        PointShadowMaps m_point_shadows{};
+        std::vector<ShadowCandidate> m_shadow_candidates;
+        GLuint m_point_shadow_draws{0};    // ring buffer holding this frame's caster indices + commands
+        GLintptr m_point_shadow_command_offset{0};
+
+        // Shadows
+        bool m_cascaded_shadows{true};       // off: one fixed box around the origin, as before
+        int m_cascade_count{4};
+        float m_shadow_distance{100.f};      // how far from the camera cascades reach
+        float m_cascade_split_lambda{0.75f}; // 0 = uniform splits, 1 = logarithmic
+        bool m_shadow_caching{true};         // keep static caster depth between frames (CPU culling only)
+        int m_shadow_preview_cascade{0};
+
         // Debug Settings
         float m_shadow_map_zoom{1.f};
         glm::vec2 m_shadow_map_pan{0.f, 0.f};
         bool m_wireframe_mode{false};
+        bool m_depth_prepass{false};         // lay down depth first so the colour pass shades each pixel once
+        bool m_front_to_back{true};          // CPU culling: order each batch's camera instances nearest first
+        bool m_meshlet_culling{true};        // CPU culling: draw LOD 0 camera instances meshlet by meshlet
         bool m_enable_debug_output{true};
         bool m_show_metrics{true};
         bool m_show_scene_info{true};
         bool m_show_lighting_tool{true};
+        bool m_show_gpu_profiler{true};
+        bool m_show_cpu_profiler{true};
 
     };
 }
@@ -3,6 +3,7 @@
 //STL
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 // Third-party
 #include <glad/glad.h>
@@ -12,7 +13,11 @@ namespace Hex
 {
     class Shader{
     public:
-        Shader(const std::string& vertex_path, const std::string& fragment_path);
+        // `defines` are emitted as #define lines after the #version of both stages, to select shader variants
+        Shader(const std::string& vertex_path, const std::string& fragment_path, const std::vector<std::string>& defines = {});
+        // With a geometry stage in between, e.g. to send each primitive to several layers of a layered framebuffer
+        Shader(const std::string& vertex_path, const std::string& geometry_path, const std::string& fragment_path);
+        explicit Shader(const std::string& compute_path);
         ~Shader();
 
         Shader(const Shader&) = default;
@@ -28,8 +33,10 @@ namespace Hex
 
         // Uniform setting methods
         void SetUniform1i(const std::string& name, int value);
+        void SetUniform1ui(const std::string& name, GLuint value);
         void SetUniform1f(const std::string& name, float value);
         void SetUniform2f(const std::string& name, float x, float y);
+        void SetUniform2i(const std::string& name, int x, int y);
         void SetUniformVec3(const std::string& name, const glm::vec3& value);
         void SetUniformMat4(const std::string& name, const glm::mat4& matrix);
 
@@ -38,8 +45,11 @@ namespace Hex
         std::unordered_map<std::string, GLint> m_uniform_location_cache;
 
         static std::string LoadShaderSource(const std::string& filepath);
+        static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines);
         static GLuint CompileShader(GLenum type, const std::string& source);
         void LinkProgram(GLuint vertex_shader, GLuint fragment_shader) const;
+        void LinkProgram(GLuint vertex_shader, GLuint geometry_shader, GLuint fragment_shader) const;
+        void LinkProgram(GLuint compute_shader) const;
         GLint GetUniformLocation(const std::string& name);
     };
 }
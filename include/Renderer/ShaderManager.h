@@ -14,6 +14,8 @@ namespace Hex
 	{
 	public:
 		static std::shared_ptr<Shader> GetOrCreateShader(const std::string& vertex_path, const std::string& fragment_path);
+		static std::shared_ptr<Shader> GetOrCreateShader(const std::string& vertex_path, const std::string& geometry_path, const std::string& fragment_path);
+		static std::shared_ptr<Shader> GetOrCreateComputeShader(const std::string& compute_path);
 
 	private:
 		static std::unordered_map<std::string, std::shared_ptr<Shader>> s_shader_cache;
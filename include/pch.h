@@ -30,6 +30,7 @@
 
 // Hex
 #include "Core/Logger.h"
+#include "Core/Profiler.h"
 #include "Gameplay/EntityComponents.h"
 #include "Core/Application.h"
 #include "Core/Console.h"
@@ -1,16 +1,17 @@
-#version 420 core
+#version 430 core
 precision highp float;
 
 // interpolants
 in vec3  vWorldPos;
 in vec3  vNormal;
 in vec2  vTexCoord;
-in vec4  vLightSpacePos;
 in mat3 vTBN;
 
 // output
 out vec4 fragColor;
 
+#define MAX_CASCADES 4
+
 // same UBO as in the vertex shader
 layout(std140, binding = 0) uniform RenderData {
     mat4 view;
@@ -24,23 +25,108 @@ layout(std140, binding = 0) uniform RenderData {
     float _pad3;
 
     int  wireframe;
-    float _pad4[3];
+    float _pad4, _pad5, _pad6;
+
+    vec4 frustum_planes[6];
+    vec4 cascade_planes[MAX_CASCADES * 6];
+
+    // the shadow map cascades, one layer each
+    mat4 light_space_matrices[MAX_CASCADES];
+    vec4 cascade_splits;    // view-space distance each cascade ends at
+    int  cascade_count;     // 0 = shadows off
+    int  _pad7, _pad8, _pad9;
+
+    // clustered lights (LightGrid)
+    uvec3 cluster_grid;     // tiles x, tiles y, depth slices
+    uint  _pad10;
+    vec4  cluster_params;   // tiles per pixel x / y, slice scale, slice bias
+};
+
+#ifdef MATERIAL_ATLAS
+// maps live in shared texture array pages (TextureAtlas); each instance brings the layers of its material
+flat in uint vMaterialIndex;
+
+struct MaterialRecord {
+    ivec4 layers;    // albedo, normal, roughness, metallic; -1 = no map
+    ivec4 layers2;   // ao
+};
+
+layout(std430, binding = 7) readonly buffer MaterialRecords {
+    MaterialRecord material_records[];
+};
+
+layout(binding = 0) uniform sampler2DArray albedoMap;
+layout(binding = 1) uniform sampler2DArray normalMap;
+layout(binding = 2) uniform sampler2DArray roughnessMap;
+layout(binding = 3) uniform sampler2DArray metallicMap;
+layout(binding = 4) uniform sampler2DArray aoMap;
+
+#define ALBEDO_LAYER    material_records[vMaterialIndex].layers.x
+#define NORMAL_LAYER    material_records[vMaterialIndex].layers.y
+#define ROUGHNESS_LAYER material_records[vMaterialIndex].layers.z
+#define METALLIC_LAYER  material_records[vMaterialIndex].layers.w
+#define AO_LAYER        material_records[vMaterialIndex].layers2.x
+
+#define HAS_ALBEDO_MAP    (ALBEDO_LAYER >= 0)
+#define HAS_NORMAL_MAP    (NORMAL_LAYER >= 0)
+#define HAS_ROUGHNESS_MAP (ROUGHNESS_LAYER >= 0)
+#define HAS_METALLIC_MAP  (METALLIC_LAYER >= 0)
+#define HAS_AO_MAP        (AO_LAYER >= 0)
+
+#define MAP_COORD(layer) vec3(vTexCoord, float(layer))
+#else
+// per-material flags, uploaded once when the material is loaded (Material::CreateParameterBlock)
+layout(std140, binding = 1) uniform MaterialData {
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasRoughnessMap;
+    int hasMetallicMap;
+    int hasAoMap;
 };
 
-// the shadow map
-uniform sampler2DShadow  shadow_map;
+// texture units are fixed here rather than set per draw; 0..4 match Material::Apply
+layout(binding = 0) uniform sampler2D albedoMap;
+layout(binding = 1) uniform sampler2D normalMap;
+layout(binding = 2) uniform sampler2D roughnessMap;
+layout(binding = 3) uniform sampler2D metallicMap;
+layout(binding = 4) uniform sampler2D aoMap;
+
+#define HAS_ALBEDO_MAP    (hasAlbedoMap != 0)
+#define HAS_NORMAL_MAP    (hasNormalMap != 0)
+#define HAS_ROUGHNESS_MAP (hasRoughnessMap != 0)
+#define HAS_METALLIC_MAP  (hasMetallicMap != 0)
+#define HAS_AO_MAP        (hasAoMap != 0)
+
+#define MAP_COORD(layer) vTexCoord
+#endif
+
+layout(binding = 5) uniform sampler2DArrayShadow shadow_map;
+layout(binding = 6) uniform samplerCubeArrayShadow point_shadow_maps; // distance / range, one cube per shadowed point light
+
+// point and spot lights; points have spot_scale 0 and spot_offset 1, so their cone term is always 1
+struct Light {
+    vec3  position;
+    float range;
+    vec3  color;        // colour * intensity
+    float spot_scale;
+    vec3  direction;    // where a spot light points
+    float spot_offset;
+    int   shadow_index; // cube in point_shadow_maps, -1 for none
+    float _pad0, _pad1, _pad2;
+};
 
-// a single albedo texture
-uniform sampler2D albedoMap;
-uniform sampler2D normalMap;
-uniform sampler2D roughnessMap;
-uniform sampler2D metallicMap;
-uniform sampler2D aoMap;
+layout(std430, binding = 2) readonly buffer Lights {
+    Light lights[];
+};
 
-uniform bool hasAlbedoMap, hasNormalMap, hasRoughnessMap, hasMetallicMap, hasAoMap;
+// per cluster: offset and count of its run in light_indices
+layout(std430, binding = 3) readonly buffer LightClusters {
+    uvec2 light_clusters[];
+};
 
-// toggle shadows on/off
-uniform bool     should_shade;
+layout(std430, binding = 4) readonly buffer LightIndices {
+    uint light_indices[];
+};
 
 // Schlick’s Fresnel
 vec3 fresnelSchlick(float cosTheta, vec3 F0) {
@@ -68,8 +154,70 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness) {
     return ggx1 * ggx2;
 }
 
+// Cook-Torrance for one light, already multiplied by N.L; scale by the light's radiance
+vec3 BRDF(vec3 N, vec3 V, vec3 L, vec3 albedo, float rough, float metal) {
+    vec3 H = normalize(V + L);
+
+    vec3 F0    = mix(vec3(0.04), albedo, metal);
+    float NDF  = DistributionGGX(N, H, rough);
+    float G    = GeometrySmith(N, V, L, rough);
+    vec3  F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+    vec3  numerator   = NDF * G * F;
+    float denom       = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.001;
+    vec3  specular    = numerator / denom;
+
+    vec3 kD   = (1.0 - F) * (1.0 - metal);
+    float NdotL = max(dot(N, L), 0.0);
+
+    return (kD * albedo / 3.14159265 + specular) * NdotL;
+}
+
+// Every point and spot light of this fragment's cluster
+// Hardware-filtered cube shadow test; the stored depth is distance to the light over its range
+float PointShadow(Light light, vec3 toLight, float dist, float NdotL) {
+    float bias = max(0.02 * (1.0 - NdotL), 0.004);
+    return texture(point_shadow_maps, vec4(-toLight, float(light.shadow_index)), dist / light.range - bias);
+}
+
+vec3 ClusteredLighting(vec3 worldPos, vec3 N, vec3 V, vec3 albedo, float rough, float metal) {
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    uvec2 tile  = min(uvec2(gl_FragCoord.xy * cluster_params.xy), cluster_grid.xy - 1u);
+    uint  slice = uint(clamp(floor(log(viewDepth) * cluster_params.z + cluster_params.w), 0.0, float(cluster_grid.z - 1u)));
+    uvec2 cluster = light_clusters[tile.x + (tile.y + slice * cluster_grid.y) * cluster_grid.x];
+
+    vec3 Lo = vec3(0.0);
+    for (uint i = 0u; i < cluster.y; ++i) {
+        Light light = lights[light_indices[cluster.x + i]];
+        vec3  toLight = light.position - worldPos;
+        float dist2   = dot(toLight, toLight);
+        vec3  L       = toLight * inversesqrt(max(dist2, 1e-8));
+
+        // inverse square, windowed so it reaches exactly 0 at the light's range
+        float ratio  = dist2 / (light.range * light.range);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float falloff = window * window / (dist2 + 1.0);
+        float cone   = clamp(dot(-L, light.direction) * light.spot_scale + light.spot_offset, 0.0, 1.0);
+        float shadow = light.shadow_index >= 0 ? PointShadow(light, toLight, sqrt(dist2), max(dot(N, L), 0.0)) : 1.0;
+
+        Lo += BRDF(N, V, L, albedo, rough, metal) * light.color * (falloff * cone * cone * shadow);
+    }
+    return Lo;
+}
+
 // PCF + slope‐based bias shadow test
-float ShadowCalculation(vec4 lightSpacePos, vec3 N, vec3 L) {
+float ShadowCalculation(vec3 worldPos, vec3 N, vec3 L) {
+    // 0) pick the first cascade that reaches this fragment
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    if (viewDepth > cascade_splits[cascade_count - 1])
+    return 1.0; // beyond the last cascade → fully lit
+
+    int layer = cascade_count - 1;
+    for (int i = 0; i < cascade_count; ++i) {
+        if (viewDepth <= cascade_splits[i]) { layer = i; break; }
+    }
+    vec4 lightSpacePos = light_space_matrices[layer] * vec4(worldPos, 1.0);
+
     // 1) project into NDC, then [0,1]
     vec3 proj = lightSpacePos.xyz / lightSpacePos.w;
     proj = proj * 0.5 + 0.5;
@@ -82,7 +230,7 @@ float ShadowCalculation(vec4 lightSpacePos, vec3 N, vec3 L) {
 
     // 3) PCF: 3×3 sample kernel
     float shadow = 0.0;
-    ivec2 texSize   = textureSize(shadow_map, 0);
+    ivec2 texSize   = textureSize(shadow_map, 0).xy;
     vec2  texelSize = 1.0 / vec2(texSize);
 
     // reference depth is proj.z - bias
@@ -92,7 +240,7 @@ float ShadowCalculation(vec4 lightSpacePos, vec3 N, vec3 L) {
         for (int y = -1; y <= 1; ++y) {
             vec2 offsetUV = proj.xy + vec2(x, y) * texelSize;
             // each texture() returns 0.0 (in shadow) or 1.0 (lit)
-            shadow += texture(shadow_map, vec3(offsetUV, ref));
+            shadow += texture(shadow_map, vec4(offsetUV, float(layer), ref));
         }
     }
     shadow /= 9.0;
@@ -106,22 +254,22 @@ void main() {
         return;
     }
 
-    vec3 albedo = hasAlbedoMap
-    ? texture(albedoMap, vTexCoord).rgb
+    vec3 albedo = HAS_ALBEDO_MAP
+    ? texture(albedoMap, MAP_COORD(ALBEDO_LAYER)).rgb
     : vec3(1.0);
-    float rough = hasRoughnessMap
-    ? texture(roughnessMap, vTexCoord).r
+    float rough = HAS_ROUGHNESS_MAP
+    ? texture(roughnessMap, MAP_COORD(ROUGHNESS_LAYER)).r
     : 0.5;
-    float metal = hasMetallicMap
-    ? texture(metallicMap, vTexCoord).r
+    float metal = HAS_METALLIC_MAP
+    ? texture(metallicMap, MAP_COORD(METALLIC_LAYER)).r
     : 0.0;
-    float ao    = hasAoMap
-    ? texture(aoMap, vTexCoord).r
+    float ao    = HAS_AO_MAP
+    ? texture(aoMap, MAP_COORD(AO_LAYER)).r
     : 1.0;
 
     // 2) Normal‐map in tangent‐space → world‐space
-    vec3 normSample = hasNormalMap
-    ? (texture(normalMap, vTexCoord).xyz * 2.0 - 1.0)
+    vec3 normSample = HAS_NORMAL_MAP
+    ? (texture(normalMap, MAP_COORD(NORMAL_LAYER)).xyz * 2.0 - 1.0)
     : vec3(0,0,1);
     // if your maps are OpenGL-style:
     normSample.g = -normSample.g;
@@ -145,35 +293,21 @@ void main() {
     // 3) View & light vectors
     vec3 V = normalize(view_pos - vWorldPos);
     vec3 L = normalize(-light_dir);
-    vec3 H = normalize(V + L);
-
-    // 4) Cook-Torrance BRDF
-    vec3 F0    = mix(vec3(0.04), albedo, metal);
-    float NDF  = DistributionGGX(worldN, H, rough);
-    float G    = GeometrySmith(worldN, V, L, rough);
-    vec3  F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
-
-    vec3  numerator   = NDF * G * F;
-    float denom       = 4.0 * max(dot(worldN, V), 0.0) * max(dot(worldN, L), 0.0) + 0.001;
-    vec3  specular    = numerator / denom;
-
-    vec3 kD   = (1.0 - F) * (1.0 - metal);
-    float NdotL = max(dot(worldN, L), 0.0);
 
-    // 5) Shadows & ambient
-    float shadow = should_shade
-    ? ShadowCalculation(vLightSpacePos, worldN, L)
+    // 4) Shadows & ambient
+    float shadow = cascade_count > 0
+    ? ShadowCalculation(vWorldPos, worldN, L)
     : 1.0;
     vec3 ambient = vec3(0.03) * albedo * ao;
 
-    // 6) Final lighting
-    vec3 Lo = (kD * albedo / 3.14159265 + specular)
+    // 5) Final lighting: the directional light (Cook-Torrance BRDF), then the clustered ones
+    vec3 Lo = BRDF(worldN, V, L, albedo, rough, metal)
     * light_color
-    * NdotL
     * shadow;
+    Lo += ClusteredLighting(vWorldPos, worldN, V, albedo, rough, metal);
     vec3 color = ambient + Lo;
 
-    // 7) Gamma‐correct
+    // 6) Gamma‐correct
     color = pow(color, vec3(1.0 / 2.2));
     fragColor = vec4(color, 1.0);
 }
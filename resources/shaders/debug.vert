@@ -1,15 +1,17 @@
-#version 420 core
+#version 430 core
 
-// per-vertex attributes
-layout(location = 0) in vec3 aPosition;
-layout(location = 1) in vec3 aNormal;
+// per-vertex attributes; compact vertices arrive still encoded (see GeometryPool::SetupVertexArray)
+layout(location = 0) in vec4 aPosition; // compact: quantised xyz, w = bitangent sign as 0 or 1
+layout(location = 1) in vec3 aNormal;   // compact: octahedral xy
 layout(location = 2) in vec2 aTexCoord;
 
-// per-instance model matrix (locations 3–6)
-layout(location = 3) in mat4 instanceModel;
-layout(location = 7) in vec4 aTangent;  // xyz = tangent, w = bitangent sign (+1 or –1)
+// per-instance index into the instance table
+layout(location = 3) in uint aInstanceIndex;
+layout(location = 7) in vec4 aTangent;  // xyz = tangent, w = bitangent sign (+1 or –1); compact: octahedral xy
 
-// per‐frame camera + light data in a UBO
+#define MAX_CASCADES 4
+
+// per‐frame camera + light data in a UBO; must match debug.frag
 layout(std140, binding = 0) uniform RenderData {
     mat4 view;
     mat4 projection;
@@ -22,42 +24,94 @@ layout(std140, binding = 0) uniform RenderData {
     float _pad3;
 
     int  wireframe;
-    float _pad4[3];
+    float _pad4, _pad5, _pad6;
+
+    vec4 frustum_planes[6];
+    vec4 cascade_planes[MAX_CASCADES * 6];
+
+    mat4 light_space_matrices[MAX_CASCADES];
+    vec4 cascade_splits;
+    int  cascade_count;
+    int  _pad7, _pad8, _pad9;
+
+    uvec3 cluster_grid;
+    uint  _pad10;
+    vec4  cluster_params;
 };
 
-uniform mat4 light_space_matrix;
+// model matrices of every render proxy, shared by all passes
+layout(std430, binding = 0) readonly buffer InstanceTable {
+    mat4 instance_models[];
+};
+
+// how each proxy's mesh stores its vertices; must match Hex::VertexDecode
+struct VertexDecode {
+    vec4 offset;   // xyz: object-space position of a zero vertex; w: 1 for compact vertices
+    vec4 scale;    // xyz: size of the quantisation box (1 for full-float vertices)
+};
+layout(std430, binding = 1) readonly buffer InstanceDecode {
+    VertexDecode instance_decode[];
+};
+
+// inverse of OctahedralEncode in Mesh.cpp
+vec3 OctahedralDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+#ifdef MATERIAL_ATLAS
+// atlas material record of every render proxy, set up by Renderer::UploadInstances
+layout(std430, binding = 6) readonly buffer InstanceMaterials {
+    uint instance_materials[];
+};
+flat out uint vMaterialIndex;
+#endif
 
 // outputs to the fragment shader
 out vec3  vWorldPos;
 out vec3  vNormal;
 out vec2  vTexCoord;
-out vec4  vLightSpacePos;
 out mat3 vTBN;
 
+// must match depth.vert exactly for the pre-pass's GL_EQUAL test
+invariant gl_Position;
+
 void main() {
     // apply per-instance model
-    vec4 worldPos = instanceModel * vec4(aPosition, 1.0);
+    mat4 instanceModel = instance_models[aInstanceIndex];
+    VertexDecode decode = instance_decode[aInstanceIndex];
+    vec3 position = decode.offset.xyz + aPosition.xyz * decode.scale.xyz;
+    vec4 worldPos = instanceModel * vec4(position, 1.0);
     vWorldPos = worldPos.xyz;
 
+    bool compact = decode.offset.w > 0.5;
+    vec3 normal  = compact ? OctahedralDecode(aNormal.xy) : aNormal;
+    vec4 tangent = compact ? vec4(OctahedralDecode(aTangent.xy), aPosition.w * 2.0 - 1.0) : aTangent;
+
     // normal‐matrix (inverse-transpose of model)
     mat3 normalMat = mat3(transpose(inverse(instanceModel)));
 
     // N in world‐space
-    vec3 N = normalize(normalMat * aNormal);
+    vec3 N = normalize(normalMat * normal);
     vNormal = N;
 
     // T in world‐space, then orthonormalize it against N
-    vec3 T = normalize(normalMat * aTangent.xyz);
+    vec3 T = normalize(normalMat * tangent.xyz);
     T = normalize(T - N * dot(N, T));  // Gram–Schmidt
 
     // B via cross + handedness
-    vec3 B = cross(N, T) * aTangent.w;
+    vec3 B = cross(N, T) * tangent.w;
 
     vTBN = mat3(T, B, N);
 
-    // UVs and shadow coords
+    // UVs; shadow coords are picked per cascade in the fragment shader
     vTexCoord     = aTexCoord;
-    vLightSpacePos = light_space_matrix * worldPos;
+
+#ifdef MATERIAL_ATLAS
+    vMaterialIndex = instance_materials[aInstanceIndex];
+#endif
 
     // clip
     gl_Position = projection * view * worldPos;
@@ -0,0 +1,5 @@
+#version 430 core
+
+// Depth only; leaving gl_FragDepth alone keeps early depth testing on
+void main() {
+}
@@ -0,0 +1,33 @@
+#version 430 core
+
+// Position-only twin of debug.vert for the depth pre-pass. gl_Position must come out bit-identical
+// to the colour pass for its GL_EQUAL depth test, hence the same expression and `invariant`.
+layout(location = 0) in vec4 aPosition;
+layout(location = 3) in uint aInstanceIndex;
+
+layout(std140, binding = 0) uniform RenderData {
+    mat4 view;
+    mat4 projection;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceTable {
+    mat4 instance_models[];
+};
+
+struct VertexDecode {
+    vec4 offset;
+    vec4 scale;
+};
+layout(std430, binding = 1) readonly buffer InstanceDecode {
+    VertexDecode instance_decode[];
+};
+
+invariant gl_Position;
+
+void main() {
+    mat4 instanceModel = instance_models[aInstanceIndex];
+    VertexDecode decode = instance_decode[aInstanceIndex];
+    vec3 position = decode.offset.xyz + aPosition.xyz * decode.scale.xyz;
+    vec4 worldPos = instanceModel * vec4(position, 1.0);
+    gl_Position = projection * view * worldPos;
+}
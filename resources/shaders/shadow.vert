@@ -1,8 +1,20 @@
-#version 420 core
+#version 430 core
 
-layout(location = 0) in vec3 position;
-// — per‐instance model matrix (locations 3,4,5,6) —
-layout(location = 3) in mat4 instanceModel;
+layout(location = 0) in vec4 position;   // compact vertices: quantised, see debug.vert
+// — per‐instance index into the instance table —
+layout(location = 3) in uint aInstanceIndex;
+
+layout(std430, binding = 0) readonly buffer InstanceTable {
+    mat4 instance_models[];
+};
+
+struct VertexDecode {
+    vec4 offset;
+    vec4 scale;
+};
+layout(std430, binding = 1) readonly buffer InstanceDecode {
+    VertexDecode instance_decode[];
+};
 
 // per‐draw uniforms
 uniform mat4 light_view;
@@ -10,8 +22,9 @@ uniform mat4 light_projection;
 
 void main()
 {
+    VertexDecode decode = instance_decode[aInstanceIndex];
     gl_Position = light_projection
     * light_view
-    * instanceModel
-    * vec4(position, 1.0);
+    * instance_models[aInstanceIndex]
+    * vec4(decode.offset.xyz + position.xyz * decode.scale.xyz, 1.0);
 }
\ No newline at end of file
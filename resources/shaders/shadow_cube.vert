@@ -1,13 +1,23 @@
-#version 420
+#version 430 core
 
-layout(location = 0) in vec3 position;
+layout(location = 0) in vec4 position;   // compact vertices: quantised, see debug.vert
+// — per‐instance index into the instance table —
+layout(location = 3) in uint aInstanceIndex;
 
-uniform mat4 shadow_proj;          // Projection matrix
-uniform mat4 shadow_view;          // View matrix for the specific cube face
+layout(std430, binding = 0) readonly buffer InstanceTable {
+    mat4 instance_models[];
+};
 
-out vec3 frag_pos_world;           // World-space position of the fragment
+struct VertexDecode {
+    vec4 offset;
+    vec4 scale;
+};
+layout(std430, binding = 1) readonly buffer InstanceDecode {
+    VertexDecode instance_decode[];
+};
 
+// World-space position; shadow_cube.geom projects it once per cube face
 void main() {
-    frag_pos_world = position;
-    gl_Position = shadow_proj * shadow_view * vec4(position, 1.0);
-}
\ No newline at end of file
+    VertexDecode decode = instance_decode[aInstanceIndex];
+    gl_Position = instance_models[aInstanceIndex] * vec4(decode.offset.xyz + position.xyz * decode.scale.xyz, 1.0);
+}
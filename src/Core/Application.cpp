@@ -21,6 +21,7 @@ namespace Hex
 	Application::~Application()
 	{
 		// Cleanup
+		if (m_specification.headless) return;
 		ImGui_ImplOpenGL3_Shutdown();
 		ImGui_ImplGlfw_Shutdown();
 		ImGui::DestroyContext();
@@ -34,12 +35,13 @@ namespace Hex
 	void Application::Init(const AppSpecification& application_spec)
 	{
 		InitTimezone();
+		HEX_PROFILE_THREAD("Main");
 
 		m_console = std::make_shared<Console>();
 		m_entity_manager = std::make_unique<EntityManager>();
 		m_renderer = std::make_unique<Renderer>(m_entity_manager->GetRegistry() ,application_spec, m_console);
 
-		InitImgui(m_renderer->GetWindow());
+		if (!application_spec.headless) InitImgui(m_renderer->GetWindow());
 
 		m_specification = application_spec;
 
@@ -157,22 +159,45 @@ namespace Hex
 	{
 		float delta_time = 0.0f;
 		float last_frame = 0.0f;
+
+		// Headless runs step the scene at a fixed rate, so every run animates through the same frames
+		constexpr float k_headless_delta_time = 1.0f / 60.0f;
+		const bool headless = m_specification.headless;
+		const double start_time = glfwGetTime();
+		uint32_t frame_count = 0;
 		
 		while (m_running && !glfwWindowShouldClose(m_renderer->GetWindow()))
 		{
+			if (headless && frame_count == m_specification.headless_frames) break;
+			++frame_count;
+
+			HEX_PROFILE_FRAME();
+			HEX_PROFILE_SCOPE("Frame");
+
 			const float current_frame = static_cast<float>(glfwGetTime());
-			delta_time = current_frame - last_frame;
+			delta_time = headless ? k_headless_delta_time : current_frame - last_frame;
 			last_frame = current_frame;
 
 			m_entity_manager->TickComponents(delta_time);
 			m_renderer->Tick(delta_time);
 
-			glfwPollEvents();
+			{
+				HEX_PROFILE_SCOPE("glfwPollEvents");
+				glfwPollEvents();
+			}
 
 
 
 			//m_entity_manager->PrintEntitiesWithComponent<Position>();
 			//m_entity_manager->PrintEntitiesWithComponent<Velocity>();
 		}
+
+		if (headless && frame_count > 0)
+		{
+			glFinish(); // count the last frames' GPU work too
+			const double total_ms = (glfwGetTime() - start_time) * 1000.0;
+			Log(LogLevel::Info, std::format("Headless run: {} frames in {:.1f} ms, {:.3f} ms per frame",
+											frame_count, total_ms, total_ms / frame_count));
+		}
 	}
 }
@@ -0,0 +1,159 @@
+#include "pch.h"
+
+#if !PRODUCTION_BUILD
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+// Hex
+#include "Core/Profiler.h"
+
+namespace Hex
+{
+	static uint64_t SteadyNanoseconds()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	Profiler& Profiler::Get()
+	{
+		static Profiler instance;
+		return instance;
+	}
+
+	Profiler::Profiler() : m_start_ns(SteadyNanoseconds())
+	{
+		m_trace.reserve(k_trace_capacity);
+	}
+
+	uint64_t Profiler::Now() const
+	{
+		return SteadyNanoseconds() - m_start_ns;
+	}
+
+	ProfileThreadBuffer& Profiler::ThisThread()
+	{
+		thread_local ProfileThreadBuffer* buffer = nullptr;
+		if (!buffer)
+		{
+			std::lock_guard<std::mutex> lock(m_threads_mutex);
+			auto& created = m_threads.emplace_back(std::make_unique<ProfileThreadBuffer>());
+			created->index = static_cast<uint32_t>(m_threads.size() - 1);
+			m_thread_names.push_back("Thread " + std::to_string(created->index));
+			buffer = created.get();
+		}
+		return *buffer;
+	}
+
+	void Profiler::SetThreadName(const char* name)
+	{
+		const uint32_t index = ThisThread().index;
+		std::lock_guard<std::mutex> lock(m_threads_mutex);
+		m_thread_names[index] = name;
+	}
+
+	std::vector<std::string> Profiler::GetThreadNames()
+	{
+		std::lock_guard<std::mutex> lock(m_threads_mutex);
+		return m_thread_names;
+	}
+
+	void Profiler::Collect(ProfileThreadBuffer& buffer, std::vector<ProfileEvent>& out)
+	{
+		constexpr uint64_t capacity = ProfileThreadBuffer::k_capacity;
+		const uint64_t written = buffer.written.load(std::memory_order_acquire);
+		uint64_t first = std::max(buffer.collected, written > capacity ? written - capacity : 0);
+		m_lost_events += first - buffer.collected;
+
+		const size_t copied_begin = out.size();
+		for (uint64_t i = first; i < written; ++i)
+			out.push_back(buffer.events[i % capacity]);
+
+		// If the owner lapped the ring while we copied, the oldest copies may be torn
+		const uint64_t written_after = buffer.written.load(std::memory_order_acquire);
+		if (written_after > capacity && written_after - capacity > first)
+		{
+			const uint64_t torn = std::min(written_after - capacity, written) - first;
+			out.erase(out.begin() + static_cast<std::ptrdiff_t>(copied_begin),
+					  out.begin() + static_cast<std::ptrdiff_t>(copied_begin + torn));
+			m_lost_events += torn;
+		}
+		buffer.collected = written;
+	}
+
+	void Profiler::BeginFrame()
+	{
+		const uint64_t now = Now();
+
+		m_collected.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_threads_mutex);
+			for (auto& buffer : m_threads)
+				Collect(*buffer, m_collected);
+		}
+
+		for (const ProfileEvent& event : m_collected)
+		{
+			if (m_trace.size() < k_trace_capacity)
+				m_trace.push_back(event);
+			else
+				m_trace[m_trace_next] = event;
+			m_trace_next = (m_trace_next + 1) % k_trace_capacity;
+		}
+
+		if (!paused)
+		{
+			m_last_frame.begin_ns = m_frame_begin_ns;
+			m_last_frame.end_ns = now;
+			m_last_frame.events.swap(m_collected);
+		}
+		m_frame_begin_ns = now;
+	}
+
+	bool Profiler::WriteChromeTrace(const std::string& path)
+	{
+		std::ofstream out(path, std::ofstream::out | std::ofstream::trunc);
+		if (!out) return false;
+
+		const auto write_string = [&out](const std::string_view text) {
+			out << '"';
+			for (const char c : text)
+			{
+				if (c == '"' || c == '\\') out << '\\';
+				out << c;
+			}
+			out << '"';
+		};
+
+		// Complete ("X") events in microseconds, plus one metadata event naming each thread
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		const std::vector<std::string> thread_names = GetThreadNames();
+		for (size_t t = 0; t < thread_names.size(); ++t)
+		{
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":";
+			write_string(thread_names[t]);
+			out << "}}";
+			first = false;
+		}
+
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		for (const ProfileEvent& event : m_trace)
+		{
+			out << (first ? "" : ",\n") << "{\"name\":";
+			write_string(event.name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+				<< ",\"ts\":" << static_cast<double>(event.begin_ns) * 1e-3
+				<< ",\"dur\":" << static_cast<double>(event.end_ns - event.begin_ns) * 1e-3 << '}';
+			first = false;
+		}
+		out << "\n]}\n";
+		return static_cast<bool>(out);
+	}
+}
+
+#endif
@@ -1,6 +1,7 @@
 ﻿#include "pch.h"
 
 #include <filesystem>
+#include <format>
 
 // Third-party
 #include <stb_image/stb_image.h>
@@ -12,23 +13,30 @@
 #include "Core/ResourceManager.h"
 #include "Renderer/Data/Model.h"
 #include "Renderer/Data/Mesh.h"
+#include "Renderer/Data/MeshOptimizer.h"
+#include "Renderer/Data/MeshSimplifier.h"
+#include "Renderer/Data/Meshlet.h"
 #include "Renderer/Shader.h"
 #include "Renderer/Data/Material.h"
+#include "Renderer/Data/TextureAtlas.h"
 
 namespace fs = std::filesystem;
 
 namespace Hex
 {
-    std::shared_ptr<Model> ResourceManager::LoadModel(const std::string &filepath)
+    std::shared_ptr<Model> ResourceManager::LoadModel(const std::string &filepath, const VertexFormat format)
     {
         auto abs = Canonical(filepath);
-        return Load<Model>(abs, abs);
+        const std::string key = format == VertexFormat::Compact ? abs + "|compact" : abs;
+        return Load<Model>(key, abs, format);
     }
 
-    std::shared_ptr<Mesh> ResourceManager::LoadMesh(const std::string &filepath, const unsigned int & meshIndex)
+    std::shared_ptr<Mesh> ResourceManager::LoadMesh(const std::string &filepath, const unsigned int & meshIndex,
+                                                    const VertexFormat format)
     {
         std::string abs = Canonical(filepath);
         std::string key = abs + "#" + std::to_string(meshIndex);
+        if (format == VertexFormat::Compact) key += "|compact";
         return LoadWith<Mesh>(key, [=]() {
             Assimp::Importer importer;
             const aiScene* scene = importer.ReadFile(
@@ -78,7 +86,50 @@ namespace Hex
                 const auto& face = am->mFaces[f];
                 idx.insert(idx.end(), face.mIndices, face.mIndices + face.mNumIndices);
             }
-            return std::make_shared<Mesh>(std::move(verts), std::move(idx));
+
+            // object-space bounds for culling: AABB, then a sphere around its centre
+            MeshBounds bounds;
+            if (!verts.empty()) {
+                bounds.box = { verts.front().pos, verts.front().pos };
+                for (const auto& v : verts) {
+                    bounds.box.min = glm::min(bounds.box.min, v.pos);
+                    bounds.box.max = glm::max(bounds.box.max, v.pos);
+                }
+
+                bounds.sphere.center = bounds.box.GetCenter();
+                float radius2 = 0.0f;
+                for (const auto& v : verts) {
+                    const glm::vec3 d = v.pos - bounds.sphere.center;
+                    radius2 = std::max(radius2, glm::dot(d, d));
+                }
+                bounds.sphere.radius = std::sqrt(radius2);
+            }
+
+            // triangles in post-transform cache order, then outward-facing clusters first
+            const float acmr_before = ComputeAcmr(idx.data(), idx.size());
+            const size_t clusters = OptimizeOverdraw(verts, idx);
+
+            // coarser index buffers over the same vertices, for distant instances
+            auto lods = BuildLodChain(verts, idx, k_max_mesh_lods - 1);
+            for (auto& level : lods) OptimizeOverdraw(verts, level);
+            if (!lods.empty()) {
+                std::string counts = std::to_string(idx.size() / 3);
+                for (const auto& level : lods) counts += " -> " + std::to_string(level.size() / 3);
+                Log(LogLevel::Info, std::format("LoadMesh: {} LODs for \"{}\" ({} triangles)", lods.size() + 1, key, counts));
+            }
+
+            // clusters of LOD 0 that can be culled on their own; reorders idx so each is one run.
+            // Seeds follow the optimised order and each meshlet grows across shared vertices, so both
+            // orders mostly survive; the ACMR below is measured after it.
+            auto meshlets = BuildMeshlets(verts, idx);
+
+            Log(LogLevel::Info, std::format("LoadMesh: ACMR {:.3f} -> {:.3f} for \"{}\" ({} overdraw clusters)",
+                                            acmr_before, ComputeAcmr(idx.data(), idx.size()), key, clusters));
+
+            // vertices in first-use order; meshlets only hold index ranges, so they are unaffected
+            OptimizeVertexFetch(verts, idx, lods);
+
+            return std::make_shared<Mesh>(std::move(verts), std::move(idx), bounds, lods, std::move(meshlets), format);
         });
     }
 
@@ -99,12 +150,16 @@ namespace Hex
 
         return LoadWith<Material>(key, [=]() {
             auto mat = std::make_shared<Material>();
-            mat->shader = LoadShader(vs, fs);
             if (!albedoTex.empty())    mat->albedo_map    = LoadTexture(albedoTex);
             if (!normalTex.empty())    mat->normal_map    = LoadTexture(normalTex);
             if (!roughnessTex.empty()) mat->roughness_map = LoadTexture(roughnessTex);
             if (!metallicTex.empty()) mat->metallic_map = LoadTexture(metallicTex);
             if (!aoTex.empty()) mat->ao_map = LoadTexture(aoTex);
+            // maps in the texture atlas are sampled from its array pages instead
+            mat->shader = mat->CanUseAtlas()
+                ? LoadShader(vs, fs, { "MATERIAL_ATLAS" })
+                : LoadShader(vs, fs);
+            mat->CreateParameterBlock();
             return mat;
         });
     }
@@ -161,17 +216,23 @@ namespace Hex
 
             glGenerateMipmap(GL_TEXTURE_2D);
             stbi_image_free(data);
+
+            // Also copy it into a shared array page, so materials using it can be batched together
+            if (auto* atlas = TextureAtlas::Get())
+                atlas->Add(*tex, internalFmt, w, h);
             return tex;
         });
     }
 
-    std::shared_ptr<Shader> ResourceManager::LoadShader(const std::string &vsPath, const std::string &fsPath)
+    std::shared_ptr<Shader> ResourceManager::LoadShader(const std::string &vsPath, const std::string &fsPath,
+        const std::vector<std::string>& defines)
     {
         const auto vs = Canonical(vsPath);
         const auto fs = Canonical(fsPath);
         std::string key = vs + "|" + fs;
+        for (const auto& define : defines) key += "|" + define;
         return LoadWith<Shader>(key, [=]() {
-            return std::make_shared<Shader>(vsPath.c_str(), fsPath.c_str());
+            return std::make_shared<Shader>(vsPath.c_str(), fsPath.c_str(), defines);
         });
     }
 }
@@ -8,19 +8,22 @@ namespace Hex
 {
 	void EntityManager::TickComponents(const float& delta_time)
 	{
+		HEX_PROFILE_SCOPE("EntityManager::TickComponents");
+
 		// iterate all entities with a Transform + Rotating
 		auto view = registry.view<TransformComponent, RotatingComponent>();
 		for (auto entity : view)
 		{
-			auto &tf = view.get<TransformComponent>(entity);
 			auto &rc = view.get<RotatingComponent>(entity);
 
 			// compute the small rotation quaternion for this frame
 			float angle_rad = glm::radians(rc.rate * delta_time);
 			glm::quat dq    = glm::angleAxis(angle_rad, glm::normalize(rc.axis));
 
-			// apply it to the current orientation
-			tf.orientation = glm::normalize(dq * tf.orientation);
+			// apply it to the current orientation (patched so the render list sees the change)
+			PatchComponent<TransformComponent>(entity, [&](TransformComponent& tf) {
+				tf.orientation = glm::normalize(dq * tf.orientation);
+			});
 		}
     }
 
@@ -43,6 +43,11 @@ namespace Hex
 		return m_projection_matrix;
 	}
 
+	Frustum Camera::GetFrustum()
+	{
+		return Frustum::FromMatrix(GetProjectionMatrix() * GetViewMatrix());
+	}
+
 	void Camera::ProcessKeyboardInput(GLFWwindow* window, const float& delta_time)
 	{
 		static bool was_tab_pressed = false; // Tracks the state of the TAB key
@@ -131,7 +136,7 @@ namespace Hex
 
 	void Camera::UpdateProjectionMatrix()
 	{
-		m_projection_matrix = glm::perspective(glm::radians(m_zoom), m_aspect_ratio, 0.1f, 10000.0f);
+		m_projection_matrix = glm::perspective(glm::radians(m_zoom), m_aspect_ratio, m_near_plane, m_far_plane);
 	}
 
 	void Camera::UpdateCameraVectors()
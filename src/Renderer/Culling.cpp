@@ -0,0 +1,244 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// Third-party
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Hex
+#include "Renderer/Culling.h"
+
+namespace Hex
+{
+	void CullBounds::Resize(const size_t count)
+	{
+		center_x.resize(count); center_y.resize(count); center_z.resize(count);
+		extent_x.resize(count); extent_y.resize(count); extent_z.resize(count);
+	}
+
+	void CullBounds::Set(const size_t slot, const AABB& local, const glm::mat4& model)
+	{
+		// Arvo: the world box of a transformed box is centre' = M * centre, extents' = |M3x3| * extents
+		const glm::vec3 center = glm::vec3(model * glm::vec4(local.GetCenter(), 1.0f));
+		const glm::vec3 extents = local.GetExtents();
+		const glm::mat3 abs_basis{ glm::abs(glm::vec3(model[0])), glm::abs(glm::vec3(model[1])), glm::abs(glm::vec3(model[2])) };
+		const glm::vec3 world_extents = abs_basis * extents;
+
+		center_x[slot] = center.x; center_y[slot] = center.y; center_z[slot] = center.z;
+		extent_x[slot] = world_extents.x; extent_y[slot] = world_extents.y; extent_z[slot] = world_extents.z;
+	}
+
+	void CullBounds::Append(const CullBounds& source, const size_t slot)
+	{
+		center_x.push_back(source.center_x[slot]); center_y.push_back(source.center_y[slot]); center_z.push_back(source.center_z[slot]);
+		extent_x.push_back(source.extent_x[slot]); extent_y.push_back(source.extent_y[slot]); extent_z.push_back(source.extent_z[slot]);
+	}
+
+	// A box is outside if it lies entirely behind any plane: dot(n, c) + d + dot(|n|, e) < 0
+	bool IsVisible(const Frustum& frustum, const CullBounds& bounds, const uint32_t i)
+	{
+		for (const glm::vec4& p : frustum.planes)
+		{
+			const float distance = p.x * bounds.center_x[i] + p.y * bounds.center_y[i] + p.z * bounds.center_z[i] + p.w;
+			const float radius = std::abs(p.x) * bounds.extent_x[i] + std::abs(p.y) * bounds.extent_y[i] + std::abs(p.z) * bounds.extent_z[i];
+			if (distance + radius < 0.0f) return false;
+		}
+		return true;
+	}
+
+	// Turns a lane mask from the SIMD kernels into ascending indices
+	static void AppendMask(uint32_t mask, const uint32_t base, std::vector<uint32_t>& visible)
+	{
+		while (mask)
+		{
+			const uint32_t lane = static_cast<uint32_t>(std::countr_zero(mask));
+			visible.push_back(base + lane);
+			mask &= mask - 1;
+		}
+	}
+
+#if defined(__x86_64__) || defined(_M_X64)
+	// The AVX2 kernel is compiled for AVX2 on its own and only called when the CPU has it,
+	// so the rest of the binary still runs on any x86-64
+#if defined(__GNUC__)
+#define HEX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HEX_TARGET_AVX2
+#endif
+
+	static bool CpuSupportsAvx2()
+	{
+#if defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+#else
+		// AVX2 in leaf 7, plus OSXSAVE and the OS saving the YMM registers (XCR0 bits 1 and 2)
+		int info[4];
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#endif
+	}
+
+	static const bool s_avx2 = CpuSupportsAvx2();
+
+	// Tests boxes 8 at a time from `i`, returns where the scalar tail starts
+	HEX_TARGET_AVX2 static uint32_t FrustumCullAvx2(const Frustum& frustum, const CullBounds& bounds, uint32_t i, const uint32_t end,
+													std::vector<uint32_t>& visible)
+	{
+		__m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			px[p] = _mm256_set1_ps(plane.x); ax[p] = _mm256_set1_ps(std::abs(plane.x));
+			py[p] = _mm256_set1_ps(plane.y); ay[p] = _mm256_set1_ps(std::abs(plane.y));
+			pz[p] = _mm256_set1_ps(plane.z); az[p] = _mm256_set1_ps(std::abs(plane.z));
+			pw[p] = _mm256_set1_ps(plane.w);
+		}
+
+		for (; i + 8 <= end; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(&bounds.center_x[i]);
+			const __m256 cy = _mm256_loadu_ps(&bounds.center_y[i]);
+			const __m256 cz = _mm256_loadu_ps(&bounds.center_z[i]);
+			const __m256 ex = _mm256_loadu_ps(&bounds.extent_x[i]);
+			const __m256 ey = _mm256_loadu_ps(&bounds.extent_y[i]);
+			const __m256 ez = _mm256_loadu_ps(&bounds.extent_z[i]);
+
+			__m256 outside = _mm256_setzero_ps();
+			for (int p = 0; p < 6; ++p)
+			{
+				const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)),
+													  _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+				const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+			}
+
+			AppendMask(~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu, i, visible);
+		}
+		return i;
+	}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	// Tests boxes 4 at a time from `i`, returns where the scalar tail starts
+	static uint32_t FrustumCullSse2(const Frustum& frustum, const CullBounds& bounds, uint32_t i, const uint32_t end,
+									std::vector<uint32_t>& visible)
+	{
+		__m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			px[p] = _mm_set1_ps(plane.x); ax[p] = _mm_set1_ps(std::abs(plane.x));
+			py[p] = _mm_set1_ps(plane.y); ay[p] = _mm_set1_ps(std::abs(plane.y));
+			pz[p] = _mm_set1_ps(plane.z); az[p] = _mm_set1_ps(std::abs(plane.z));
+			pw[p] = _mm_set1_ps(plane.w);
+		}
+
+		for (; i + 4 <= end; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(&bounds.center_x[i]);
+			const __m128 cy = _mm_loadu_ps(&bounds.center_y[i]);
+			const __m128 cz = _mm_loadu_ps(&bounds.center_z[i]);
+			const __m128 ex = _mm_loadu_ps(&bounds.extent_x[i]);
+			const __m128 ey = _mm_loadu_ps(&bounds.extent_y[i]);
+			const __m128 ez = _mm_loadu_ps(&bounds.extent_z[i]);
+
+			__m128 outside = _mm_setzero_ps();
+			for (int p = 0; p < 6; ++p)
+			{
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)),
+												   _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+				const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			}
+
+			AppendMask(~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu, i, visible);
+		}
+		return i;
+	}
+#endif
+
+	void FrustumCull(const Frustum& frustum, const CullBounds& bounds, const uint32_t first, const uint32_t count,
+					 std::vector<uint32_t>& visible)
+	{
+		uint32_t i = first;
+		const uint32_t end = first + count;
+
+#if defined(__x86_64__) || defined(_M_X64)
+		if (s_avx2) i = FrustumCullAvx2(frustum, bounds, i, end, visible);
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+		i = FrustumCullSse2(frustum, bounds, i, end, visible);
+#endif
+
+		// Scalar tail, and the whole range on targets without SSE
+		for (; i < end; ++i)
+			if (IsVisible(frustum, bounds, i)) visible.push_back(i);
+	}
+
+	void MeshletCull(const Frustum& frustum, const glm::vec3& eye, const glm::mat4& model,
+					 const std::vector<Meshlet>& meshlets, std::vector<uint32_t>& visible)
+	{
+		const glm::mat3 basis(model);
+		const glm::vec3 scale{ glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]) };
+		const float max_scale = std::max({ scale.x, scale.y, scale.z });
+		const float min_scale = std::min({ scale.x, scale.y, scale.z });
+		const bool trust_cones = max_scale - min_scale <= max_scale * 1e-3f && glm::determinant(basis) > 0.0f;
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(meshlets.size()); ++i)
+		{
+			const Meshlet& meshlet = meshlets[i];
+			const glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+			const float radius = meshlet.radius * max_scale;
+
+			bool inside = true;
+			for (const glm::vec4& p : frustum.planes)
+				if (glm::dot(glm::vec3(p), center) + p.w < -radius) { inside = false; break; }
+			if (!inside) continue;
+
+			// Back-facing when every view ray into the sphere is under 90 degrees from every normal in the cone:
+			// the angle between axis and view direction, plus the cone and sphere half-angles, stays below 90
+			if (trust_cones && meshlet.cone_cutoff > 0.0f)
+			{
+				const glm::vec3 to_center = center - eye;
+				const float distance = glm::length(to_center);
+				if (distance > radius)
+				{
+					const float sin_view = radius / distance;
+					const float cos_view = std::sqrt(1.0f - sin_view * sin_view);
+					const float cos_cone = meshlet.cone_cutoff;
+					const float sin_cone = std::sqrt(1.0f - cos_cone * cos_cone);
+
+					// cos and sin of cone + view half-angles
+					const float cos_spread = cos_cone * cos_view - sin_cone * sin_view;
+					const float sin_spread = sin_cone * cos_view + cos_cone * sin_view;
+					const glm::vec3 axis = basis * meshlet.cone_axis / max_scale;
+					if (cos_spread > 0.0f && glm::dot(axis, to_center) > sin_spread * distance) continue;
+				}
+			}
+
+			visible.push_back(i);
+		}
+	}
+
+	const char* GetCullingInstructionSet()
+	{
+#if defined(__x86_64__) || defined(_M_X64)
+		if (s_avx2) return "AVX2";
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+}
@@ -0,0 +1,33 @@
+#include "pch.h"
+
+// Hex
+#include "Renderer/Data/Bounds.h"
+
+namespace Hex
+{
+    Frustum Frustum::FromMatrix(const glm::mat4& view_projection)
+    {
+        // glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const auto row = [&view_projection](const int i) {
+            return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+        };
+
+        const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+        Frustum frustum;
+        frustum.planes = {
+            r3 + r0,    // left
+            r3 - r0,    // right
+            r3 + r1,    // bottom
+            r3 - r1,    // top
+            r3 + r2,    // near (GL clip space, z in [-w, w])
+            r3 - r2     // far
+        };
+
+        // Normalise so plane.w is a real distance and sphere tests work too
+        for (auto& plane : frustum.planes)
+            plane /= glm::length(glm::vec3(plane));
+
+        return frustum;
+    }
+}
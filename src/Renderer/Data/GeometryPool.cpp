@@ -0,0 +1,275 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <format>
+#include <vector>
+
+// Hex
+#include "Renderer/Data/GeometryPool.h"
+#include "Renderer/Data/Mesh.h"
+#include "Renderer/GLState.h"
+
+namespace Hex
+{
+    std::unique_ptr<GeometryPool> GeometryPool::s_instance{nullptr};
+
+    // Size of a stream's buffer when its first mesh arrives; streams nothing uses never get one
+    static constexpr GLuint k_initial_vertex_capacity = 1u << 16;
+    static constexpr GLuint k_initial_index_capacity  = 1u << 18;
+
+    void GeometryPool::Init()
+    {
+        s_instance = std::make_unique<GeometryPool>(k_initial_vertex_capacity, k_initial_index_capacity);
+    }
+
+    void GeometryPool::Shutdown()
+    {
+        s_instance.reset();
+    }
+
+    GeometryPool::GeometryPool(const GLuint vertex_capacity, const GLuint index_capacity)
+    {
+        // Buffers are created on a stream's first allocation, see AllocateElements
+        for (Stream& stream : m_vertex_streams) stream.initial_capacity = vertex_capacity;
+        for (Stream& stream : m_index_streams) stream.initial_capacity = index_capacity;
+
+        glGenVertexArrays(static_cast<GLsizei>(m_vaos.size()), m_vaos.data());
+        for (uint32_t layout = 0; layout < k_geometry_layout_count; ++layout)
+            SetupVertexArray(layout);
+        RebindStreams();
+    }
+
+    GeometryPool::~GeometryPool()
+    {
+        glDeleteVertexArrays(static_cast<GLsizei>(m_vaos.size()), m_vaos.data());
+        for (const Stream& stream : m_vertex_streams) glDeleteBuffers(1, &stream.buffer);
+        for (const Stream& stream : m_index_streams) glDeleteBuffers(1, &stream.buffer);
+    }
+
+    GLsizei GeometryPool::GetVertexStride(const VertexFormat format)
+    {
+        return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+    }
+
+    GLsizei GeometryPool::GetIndexSize(const IndexType index_type)
+    {
+        return index_type == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
+
+    GLenum GeometryPool::GetIndexGLType(const uint32_t layout)
+    {
+        const auto index_type = static_cast<IndexType>(layout % k_index_type_count);
+        return index_type == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    GLuint GeometryPool::CreateBuffer(const GLsizeiptr size)
+    {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    void GeometryPool::SetupVertexArray(const uint32_t layout) const
+    {
+        const auto format = static_cast<VertexFormat>(layout / k_index_type_count);
+        GLState::BindVertexArray(m_vaos[layout]);
+
+        // vertex attribs: pos(0), normal(1), uv(2), tangent(7). Compact vertices land in the same
+        // locations still encoded; shaders decode them with the proxy's VertexDecode record.
+        if (format == VertexFormat::Compact)
+        {
+            glVertexAttribFormat(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompactVertex, pos));
+            glVertexAttribFormat(1, 2, GL_SHORT, GL_TRUE, offsetof(CompactVertex, normal));
+            glVertexAttribFormat(2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(CompactVertex, uv));
+            glVertexAttribFormat(7, 2, GL_SHORT, GL_TRUE, offsetof(CompactVertex, tangent));
+        }
+        else
+        {
+            glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, pos));
+            glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal));
+            glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv));
+            glVertexAttribFormat(7, 4, GL_FLOAT, GL_FALSE, offsetof(Vertex, tangent));
+        }
+
+        for (const GLuint location : { 0u, 1u, 2u, 7u })
+        {
+            glEnableVertexAttribArray(location);
+            glVertexAttribBinding(location, Mesh::k_vertex_binding);
+        }
+
+        // Per-instance uint index into the instance table at location 3, advanced once per instance
+        glEnableVertexAttribArray(3);
+        glVertexAttribIFormat(3, 1, GL_UNSIGNED_INT, 0);
+        glVertexAttribBinding(3, Mesh::k_instance_binding);
+        glVertexBindingDivisor(Mesh::k_instance_binding, 1);
+
+        GLState::BindVertexArray(0);
+    }
+
+    void GeometryPool::RebindStreams() const
+    {
+        // Buffers are VAO state, so every VAO that reads a stream needs it again after a grow
+        for (uint32_t layout = 0; layout < k_geometry_layout_count; ++layout)
+        {
+            const auto format = static_cast<VertexFormat>(layout / k_index_type_count);
+            const auto index_type = static_cast<IndexType>(layout % k_index_type_count);
+
+            GLState::BindVertexArray(m_vaos[layout]);
+            glBindVertexBuffer(Mesh::k_vertex_binding, VertexStreamOf(format).buffer, 0, GetVertexStride(format));
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexStreamOf(index_type).buffer);
+        }
+        GLState::BindVertexArray(0);
+    }
+
+    void GeometryPool::Bind(const uint32_t layout) const
+    {
+        GLState::BindVertexArray(m_vaos[layout]);
+    }
+
+    GeometryPool::Allocation GeometryPool::Allocate(const VertexFormat format, const void* vertices, const GLuint vertex_count,
+                                                    const IndexType index_type, const uint32_t* indices, const GLsizei index_count)
+    {
+        Allocation allocation;
+        allocation.format       = format;
+        allocation.index_type   = index_type;
+        allocation.vertex_count = vertex_count;
+        allocation.index_count  = index_count;
+
+        Stream& vertex_stream = VertexStreamOf(format);
+        Stream& index_stream = IndexStreamOf(index_type);
+        const GLsizeiptr stride = GetVertexStride(format);
+        const GLsizeiptr index_size = GetIndexSize(index_type);
+
+        allocation.base_vertex = static_cast<GLint>(AllocateElements(vertex_stream, vertex_count, stride,
+                                                                     format == VertexFormat::Compact ? "compact vertex" : "vertex"));
+        allocation.first_index = AllocateElements(index_stream, static_cast<GLuint>(index_count), index_size,
+                                                  index_type == IndexType::UInt16 ? "16-bit index" : "32-bit index");
+
+        // Indices stay relative to the mesh; base_vertex rebases them at draw time
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_stream.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        static_cast<GLintptr>(allocation.base_vertex) * stride,
+                        static_cast<GLsizeiptr>(vertex_count) * stride,
+                        vertices);
+
+        std::vector<uint16_t> narrowed;
+        const void* index_data = indices;
+        if (index_type == IndexType::UInt16)
+        {
+            narrowed.assign(indices, indices + index_count);
+            index_data = narrowed.data();
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, index_stream.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        static_cast<GLintptr>(allocation.first_index) * index_size,
+                        static_cast<GLsizeiptr>(index_count) * index_size,
+                        index_data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        vertex_stream.used += vertex_count;
+        index_stream.used  += static_cast<GLuint>(index_count);
+
+        return allocation;
+    }
+
+    void GeometryPool::Free(const Allocation& allocation)
+    {
+        Stream& vertex_stream = VertexStreamOf(allocation.format);
+        Stream& index_stream = IndexStreamOf(allocation.index_type);
+        vertex_stream.range.Free(static_cast<GLuint>(allocation.base_vertex), allocation.vertex_count);
+        index_stream.range.Free(allocation.first_index, static_cast<GLuint>(allocation.index_count));
+
+        vertex_stream.used -= allocation.vertex_count;
+        index_stream.used  -= static_cast<GLuint>(allocation.index_count);
+    }
+
+    GLuint GeometryPool::AllocateElements(Stream& stream, const GLuint count, const GLsizeiptr element_size, const char* name)
+    {
+        GLuint offset = 0;
+        if (!stream.range.Allocate(count, offset))
+        {
+            GrowStream(stream, std::max(stream.range.capacity + count, stream.initial_capacity), element_size, name);
+            RebindStreams();
+            stream.range.Allocate(count, offset);
+        }
+        return offset;
+    }
+
+    void GeometryPool::GrowStream(Stream& stream, const GLuint min_capacity, const GLsizeiptr element_size, const char* name)
+    {
+        const GLuint old_capacity = stream.range.capacity;
+        const GLuint new_capacity = std::max(old_capacity * 2, min_capacity);
+        const GLuint new_buffer = CreateBuffer(static_cast<GLsizeiptr>(new_capacity) * element_size);
+
+        if (old_capacity == 0)
+        {
+            Log(LogLevel::Info, std::format("GeometryPool: creating {} buffer of {} elements", name, new_capacity));
+        }
+        else
+        {
+            Log(LogLevel::Info, std::format("GeometryPool: growing {} buffer {} -> {} elements", name, old_capacity, new_capacity));
+            glBindBuffer(GL_COPY_READ_BUFFER, stream.buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                static_cast<GLsizeiptr>(old_capacity) * element_size);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &stream.buffer);
+        }
+
+        stream.buffer = new_buffer;
+        stream.range.Grow(new_capacity);
+    }
+
+    bool GeometryPool::RangeAllocator::Allocate(const GLuint size, GLuint& offset)
+    {
+        for (auto it = free_blocks.begin(); it != free_blocks.end(); ++it)
+        {
+            if (it->second < size) continue;
+
+            offset = it->first;
+            const GLuint remaining = it->second - size;
+            free_blocks.erase(it);
+            if (remaining > 0) free_blocks.emplace(offset + size, remaining);
+            return true;
+        }
+        return false;
+    }
+
+    void GeometryPool::RangeAllocator::Free(const GLuint offset, const GLuint size)
+    {
+        if (size == 0) return;
+
+        auto [it, inserted] = free_blocks.emplace(offset, size);
+
+        // merge with the following block
+        if (auto next = std::next(it); next != free_blocks.end() && it->first + it->second == next->first)
+        {
+            it->second += next->second;
+            free_blocks.erase(next);
+        }
+
+        // merge with the preceding block
+        if (it != free_blocks.begin())
+        {
+            auto prev = std::prev(it);
+            if (prev->first + prev->second == it->first)
+            {
+                prev->second += it->second;
+                free_blocks.erase(it);
+            }
+        }
+    }
+
+    void GeometryPool::RangeAllocator::Grow(const GLuint new_capacity)
+    {
+        if (new_capacity <= capacity) return;
+
+        Free(capacity, new_capacity - capacity);
+        capacity = new_capacity;
+    }
+}
@@ -1,48 +1,108 @@
 ﻿#include "pch.h"
 
 #include "Renderer/Data/Material.h"
+#include "Renderer/GLState.h"
 
 namespace Hex {
 
+    Material::~Material() {
+        if (m_parameter_buffer) {
+            GLState::ForgetBuffer(m_parameter_buffer);
+            glDeleteBuffers(1, &m_parameter_buffer);
+        }
+    }
+
+    const Texture* Material::GetMap(const size_t slot) const {
+        // Same order as the texture units in Apply()
+        switch (slot) {
+            case 0:  return albedo_map.get();
+            case 1:  return normal_map.get();
+            case 2:  return roughness_map.get();
+            case 3:  return metallic_map.get();
+            case 4:  return ao_map.get();
+            default: return nullptr;
+        }
+    }
+
+    bool Material::CanUseAtlas() const {
+        if (!TextureAtlas::Get()) return false;
+        for (size_t slot = 0; slot < k_material_map_count; ++slot) {
+            const Texture* map = GetMap(slot);
+            if (map && !map->IsAtlased()) return false;
+        }
+        return true;
+    }
+
+    void Material::CreateParameterBlock() {
+        // Atlased: the flags become layer indices in the shared record buffer, looked up per instance
+        if (CanUseAtlas()) {
+            TextureAtlas* atlas = TextureAtlas::Get();
+            MaterialRecord record;
+            TextureAtlas::Binding binding;
+            binding.shader = shader.get();
+            binding.cull_backfaces = cull_backfaces;
+            for (size_t slot = 0; slot < k_material_map_count; ++slot) {
+                const Texture* map = GetMap(slot);
+                binding.pages[slot] = map ? map->GetAtlasPage() : TextureAtlas::k_no_page;
+                record.layers[slot] = map ? static_cast<int32_t>(map->GetAtlasLayer()) : -1;
+            }
+            m_atlas_record = atlas->AddMaterial(record);
+            m_atlas_binding = atlas->InternBinding(binding);
+            return;
+        }
+
+        MaterialData data;
+        data.has_albedo_map    = albedo_map    ? 1 : 0;
+        data.has_normal_map    = normal_map    ? 1 : 0;
+        data.has_roughness_map = roughness_map ? 1 : 0;
+        data.has_metallic_map  = metallic_map  ? 1 : 0;
+        data.has_ao_map        = ao_map        ? 1 : 0;
+
+        // Immutable: a material's maps do not change after it is loaded
+        if (m_parameter_buffer) {
+            GLState::ForgetBuffer(m_parameter_buffer);
+            glDeleteBuffers(1, &m_parameter_buffer);
+        }
+        glGenBuffers(1, &m_parameter_buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_parameter_buffer);
+        glBufferStorage(GL_UNIFORM_BUFFER, sizeof(MaterialData), &data, 0);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
     void Material::Apply() const {
+        HEX_PROFILE_SCOPE("Material::Apply");
         shader->Bind();
 
-        // Feature flags
-        shader->SetUniform1i("hasAlbedoMap",    albedo_map    ? 1 : 0);
-        shader->SetUniform1i("hasNormalMap",    normal_map    ? 1 : 0);
-        shader->SetUniform1i("hasRoughnessMap", roughness_map ? 1 : 0);
-        shader->SetUniform1i("hasMetallicMap",  metallic_map  ? 1 : 0);
-        shader->SetUniform1i("hasAoMap",        ao_map        ? 1 : 0);
+        // Everything else a group of atlased materials needs is in the binding they share
+        if (m_atlas_binding) {
+            TextureAtlas::Get()->Bind(*m_atlas_binding);
+            GLState::SetEnabled(GL_CULL_FACE, cull_backfaces);
+            if (cull_backfaces) GLState::CullFace(GL_BACK);
+            return;
+        }
 
-        // Bind samplers 0..4
-        static const char* names[5] = {
-            "albedoMap","normalMap","roughnessMap","metallicMap","aoMap"
-          };
-        std::shared_ptr<Texture> texs[5] = {
-            albedo_map, normal_map,
-            roughness_map, metallic_map,
-            ao_map
+        // Feature flags live in the parameter block uploaded at load time
+        GLState::BindUniformBuffer(k_parameter_binding, m_parameter_buffer, 0, sizeof(MaterialData));
+
+        // Units 0..4 match the layout(binding) of the samplers in debug.frag
+        const Texture* texs[5] = {
+            albedo_map.get(), normal_map.get(),
+            roughness_map.get(), metallic_map.get(),
+            ao_map.get()
           };
 
         for (int unit = 0; unit < 5; ++unit) {
-            // tell GLSL this sampler lives in texture unit `unit`
-            shader->SetUniform1i(names[unit], unit);
-            glActiveTexture(GL_TEXTURE0 + unit);
             if (texs[unit]) {
                 texs[unit]->Bind(unit);
             } else {
                 // if it’s the normal slot, bind default normal; otherwise bind white
-                if (unit == 1) Texture::BindDefaultNormal();
-                else          Texture::BindWhite();
+                if (unit == 1) Texture::BindDefaultNormal(unit);
+                else          Texture::BindWhite(unit);
             }
         }
 
         // Backface culling
-        if (cull_backfaces) {
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
-        } else {
-            glDisable(GL_CULL_FACE);
-        }
+        GLState::SetEnabled(GL_CULL_FACE, cull_backfaces);
+        if (cull_backfaces) GLState::CullFace(GL_BACK);
     }
 }
@@ -1,110 +1,163 @@
 ﻿#include "pch.h"
+
+// STL
+#include <cmath>
+
+// Third-party
+#include <glm/gtc/packing.hpp>
+
+// Hex
 #include "Renderer/Data/Mesh.h"
+#include "Renderer/GLState.h"
 
 namespace Hex
 {
+    // Unit vector onto the octahedron, folded into [-1, 1]^2
+    static glm::vec2 OctahedralEncode(glm::vec3 n)
+    {
+        const float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (length == 0.0f) return { 0.0f, 0.0f };
+
+        n /= length;
+        if (n.z >= 0.0f) return { n.x, n.y };
+
+        return { (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                 (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f) };
+    }
+
+    static int16_t PackSnorm16(const float value)
+    {
+        return static_cast<int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    static std::vector<CompactVertex> CompactVertices(const std::vector<Vertex>& verts, const AABB& box, VertexDecode& decode)
+    {
+        const glm::vec3 extent = box.max - box.min;
+        decode.offset = box.min;
+        decode.compact = 1.0f;
+        decode.scale = extent;
+
+        std::vector<CompactVertex> compact(verts.size());
+        for (size_t i = 0; i < verts.size(); ++i)
+        {
+            const Vertex& v = verts[i];
+            CompactVertex& c = compact[i];
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float t = extent[axis] > 0.0f ? (v.pos[axis] - box.min[axis]) / extent[axis] : 0.0f;
+                c.pos[axis] = static_cast<uint16_t>(std::lround(glm::clamp(t, 0.0f, 1.0f) * 65535.0f));
+            }
+            c.pos[3] = v.tangent.w < 0.0f ? 0 : 65535;
+
+            const glm::vec2 normal = OctahedralEncode(v.normal);
+            const glm::vec2 tangent = OctahedralEncode(glm::vec3(v.tangent));
+            c.normal[0] = PackSnorm16(normal.x);
+            c.normal[1] = PackSnorm16(normal.y);
+            c.tangent[0] = PackSnorm16(tangent.x);
+            c.tangent[1] = PackSnorm16(tangent.y);
+
+            c.uv[0] = glm::packHalf1x16(v.uv.x);
+            c.uv[1] = glm::packHalf1x16(v.uv.y);
+        }
+        return compact;
+    }
+
     Mesh::Mesh(std::vector<Vertex> &&verts,
-               std::vector<uint32_t> &&idx)
-        : indexCount(static_cast<GLsizei>(idx.size()))
+               std::vector<uint32_t> &&idx,
+               const MeshBounds &meshBounds,
+               const std::vector<std::vector<uint32_t>> &lodIndices,
+               std::vector<Meshlet> &&meshletList,
+               const VertexFormat format)
+        : indexCount(static_cast<GLsizei>(idx.size())), bounds(meshBounds), meshlets(std::move(meshletList))
     {
-        // Regular VAO/VBO/EBO setup
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER,
-                     verts.size() * sizeof(Vertex),
-                     verts.data(),
-                     GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     idx.size() * sizeof(uint32_t),
-                     idx.data(),
-                     GL_STATIC_DRAW);
-
-        // vertex attribs: pos(0), normal(1), uv(2)
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
-                              sizeof(Vertex),
-                              (void *) offsetof(Vertex, pos));
-
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE,
-                              sizeof(Vertex),
-                              (void *) offsetof(Vertex, normal));
-
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE,
-                              sizeof(Vertex),
-                              (void *) offsetof(Vertex, uv));
-
-        glEnableVertexAttribArray(7);
-        glVertexAttribPointer(
-            7,                     // must match layout(location=7) in your VS
-            4,                     // vec4
-            GL_FLOAT,
-            GL_FALSE,
-            sizeof(Vertex),
-            (void*)offsetof(Vertex, tangent)
-        );
-        glVertexAttribDivisor(7, 0); // per-vertex
-
-        // Per-instance mat4 buffer ---
-        glGenBuffers(1, &instanceVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-        // reserve some space (you can resize later via BufferData or SubData)
-        glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(glm::mat4) * 100, // e.g. space for 100 instances
-                     nullptr,
-                     GL_DYNAMIC_DRAW);
-
-        // Each mat4 = 4 vec4s, attrib locations 3,4,5,6
-        for (int i = 0; i < 4; ++i)
+        // Every level goes after LOD 0 in one index allocation, so freeing the mesh frees them all
+        std::vector<GLsizei> lodCounts{ indexCount };
+        for (const auto& level : lodIndices) {
+            if (lodCounts.size() == k_max_mesh_lods) break;
+            idx.insert(idx.end(), level.begin(), level.end());
+            lodCounts.push_back(static_cast<GLsizei>(level.size()));
+        }
+
+        // Vertex format, VAO and buffers are shared by every mesh in the pool; indices that fit go in 16 bits
+        const IndexType indexType = verts.size() <= 65536 ? IndexType::UInt16 : IndexType::UInt32;
+        if (format == VertexFormat::Compact)
         {
-            GLuint loc = 3 + i;
-            glEnableVertexAttribArray(loc);
-            glVertexAttribPointer(loc,
-                                  4, GL_FLOAT, GL_FALSE,
-                                  sizeof(glm::mat4),
-                                  (void *) (sizeof(glm::vec4) * i));
-            // advance this attribute once per instance (not per-vertex)
-            glVertexAttribDivisor(loc, 1);
+            const auto compact = CompactVertices(verts, meshBounds.box, decode);
+            geometry = GeometryPool::Get()->Allocate(format, compact.data(), static_cast<GLuint>(compact.size()),
+                                                     indexType, idx.data(), static_cast<GLsizei>(idx.size()));
+        }
+        else
+        {
+            geometry = GeometryPool::Get()->Allocate(format, verts.data(), static_cast<GLuint>(verts.size()),
+                                                     indexType, idx.data(), static_cast<GLsizei>(idx.size()));
+        }
+
+        GLuint firstIndex = geometry.first_index;
+        for (const GLsizei count : lodCounts) {
+            lods.push_back({ firstIndex, count });
+            firstIndex += static_cast<GLuint>(count);
         }
-        // unbind instance VBO from ARRAY_BUFFER slot
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(0);
+        for (auto& meshlet : meshlets)
+            meshlet.first_index += geometry.first_index;
     }
 
     Mesh::~Mesh()
     {
-        glDeleteBuffers(1, &instanceVBO);
-        glDeleteBuffers(1, &EBO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+        // The pool may already be gone if the cache outlives the renderer
+        if (auto* pool = GeometryPool::Get())
+            pool->Free(geometry);
     }
 
     void Mesh::Draw() const
     {
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
+        GeometryPool::Get()->Bind(geometry.GetLayout());
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES,
+            indexCount,
+            GeometryPool::GetIndexGLType(geometry.GetLayout()),
+            reinterpret_cast<void*>(static_cast<uintptr_t>(geometry.first_index) * GeometryPool::GetIndexSize(geometry.index_type)),
+            geometry.base_vertex
+        );
+        GLState::BindVertexArray(0);
     }
 
-    void Mesh::DrawInstanced(GLsizei instanceCount) const
+    void Mesh::DrawInstanced(GLsizei instanceCount, GLuint baseInstance) const
     {
-        glBindVertexArray(VAO);
-        glDrawElementsInstanced(
+        GeometryPool::Get()->Bind(geometry.GetLayout());
+        glDrawElementsInstancedBaseVertexBaseInstance(
             GL_TRIANGLES,
             indexCount,
-            GL_UNSIGNED_INT,
-            nullptr,
-            instanceCount
+            GeometryPool::GetIndexGLType(geometry.GetLayout()),
+            reinterpret_cast<void*>(static_cast<uintptr_t>(geometry.first_index) * GeometryPool::GetIndexSize(geometry.index_type)),
+            instanceCount,
+            geometry.base_vertex,
+            baseInstance
         );
-        glBindVertexArray(0);
+        GLState::BindVertexArray(0);
+    }
+
+    DrawElementsIndirectCommand Mesh::MakeMeshletCommand(const GLuint instanceCount, const GLuint baseInstance, const uint32_t meshlet) const
+    {
+        return {
+            meshlets[meshlet].index_count,
+            instanceCount,
+            meshlets[meshlet].first_index,
+            geometry.base_vertex,
+            baseInstance
+        };
+    }
+
+    DrawElementsIndirectCommand Mesh::MakeDrawCommand(const GLuint instanceCount, const GLuint baseInstance, const uint32_t lod) const
+    {
+        const MeshLod& level = lods[std::min<size_t>(lod, lods.size() - 1)];
+        return {
+            static_cast<GLuint>(level.index_count),
+            instanceCount,
+            level.first_index,
+            geometry.base_vertex,
+            baseInstance
+        };
     }
 } // namespace Hex
@@ -0,0 +1,257 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+// Hex
+#include "Renderer/Data/MeshOptimizer.h"
+#include "Renderer/Data/Mesh.h"
+
+namespace Hex
+{
+    // Clusters shorter than this are not split any further for overdraw
+    static constexpr size_t k_min_cluster_triangles = 32;
+
+    namespace
+    {
+        // FIFO cache over vertex IDs below `vertex_count`. Reset() empties it without touching every entry.
+        class VertexCache
+        {
+        public:
+            VertexCache(const size_t vertex_count, const uint32_t size) : m_inserted(vertex_count, 0), m_size(size) {}
+
+            // True on a miss, which also inserts the vertex
+            bool Miss(const uint32_t vertex)
+            {
+                const uint32_t inserted = m_inserted[vertex];
+                if (inserted > m_base && m_misses - inserted < m_size) return false;
+
+                m_inserted[vertex] = ++m_misses;
+                return true;
+            }
+
+            void Reset() { m_base = m_misses; }
+
+        private:
+            std::vector<uint32_t> m_inserted; // miss count right after the vertex went in, 0 for never
+            uint32_t m_size;
+            uint32_t m_misses{0};
+            uint32_t m_base{0};
+        };
+
+        // Triangle order Tipsify picks, and where it had to jump to a dead end (the cache holds
+        // nothing useful there, so the clusters in between can move freely)
+        void Tipsify(const uint32_t* indices, const size_t index_count, std::vector<uint32_t>& order,
+                     std::vector<uint32_t>& cluster_starts)
+        {
+            const size_t triangle_count = index_count / 3;
+            order.clear();
+            order.reserve(triangle_count);
+            cluster_starts.assign(1, 0);
+            if (triangle_count == 0) return;
+
+            // Dense vertex IDs, so index buffers that skip vertices (LODs) only pay for the ones they use
+            std::vector<uint32_t> unique(indices, indices + index_count);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            const auto vertex_count = static_cast<uint32_t>(unique.size());
+
+            std::vector<uint32_t> local(index_count);
+            for (size_t i = 0; i < index_count; ++i)
+                local[i] = static_cast<uint32_t>(std::lower_bound(unique.begin(), unique.end(), indices[i]) - unique.begin());
+
+            // Triangles around each vertex, and how many of them are still to be emitted
+            std::vector<uint32_t> live(vertex_count, 0);
+            for (const uint32_t v : local) ++live[v];
+            std::vector<uint32_t> ring_offsets(vertex_count + 1, 0);
+            for (uint32_t v = 0; v < vertex_count; ++v) ring_offsets[v + 1] = ring_offsets[v] + live[v];
+            std::vector<uint32_t> ring_triangles(index_count);
+            {
+                std::vector<uint32_t> cursor(ring_offsets.begin(), ring_offsets.end() - 1);
+                for (size_t corner = 0; corner < index_count; ++corner)
+                    ring_triangles[cursor[local[corner]]++] = static_cast<uint32_t>(corner / 3);
+            }
+
+            constexpr int64_t k_cache = k_vertex_cache_size;
+            std::vector<int64_t> timestamps(vertex_count, 0);
+            int64_t time = k_cache + 1;
+
+            std::vector<uint8_t> emitted(triangle_count, 0);
+            std::vector<uint32_t> dead_ends;
+            std::vector<uint32_t> candidates;
+            uint32_t scan = 0;
+            uint32_t fan = local[0];
+
+            while (true) {
+                // Emit everything left around the fanning vertex
+                candidates.clear();
+                for (uint32_t r = ring_offsets[fan]; r < ring_offsets[fan + 1]; ++r) {
+                    const uint32_t t = ring_triangles[r];
+                    if (emitted[t]) continue;
+                    emitted[t] = 1;
+                    order.push_back(t);
+
+                    for (int c = 0; c < 3; ++c) {
+                        const uint32_t v = local[t * 3 + c];
+                        dead_ends.push_back(v);
+                        candidates.push_back(v);
+                        --live[v];
+                        if (time - timestamps[v] > k_cache) timestamps[v] = time++;
+                    }
+                }
+
+                // Next: the oldest neighbour that stays cached while its own fan goes out
+                uint32_t next = std::numeric_limits<uint32_t>::max();
+                int64_t best = -1;
+                for (const uint32_t v : candidates) {
+                    if (live[v] == 0) continue;
+                    const int64_t age = time - timestamps[v];
+                    const int64_t priority = age + 2 * static_cast<int64_t>(live[v]) <= k_cache ? age : 0;
+                    if (priority > best) { best = priority; next = v; }
+                }
+
+                // Dead end: the most recent vertex with triangles left, else the next one in order
+                if (next == std::numeric_limits<uint32_t>::max()) {
+                    while (!dead_ends.empty() && next == std::numeric_limits<uint32_t>::max()) {
+                        const uint32_t v = dead_ends.back();
+                        dead_ends.pop_back();
+                        if (live[v] > 0) next = v;
+                    }
+                    while (next == std::numeric_limits<uint32_t>::max() && scan < vertex_count) {
+                        if (live[scan] > 0) next = scan;
+                        ++scan;
+                    }
+                    if (next == std::numeric_limits<uint32_t>::max()) break;
+                    cluster_starts.push_back(static_cast<uint32_t>(order.size()));
+                }
+                fan = next;
+            }
+        }
+
+        void ApplyOrder(uint32_t* indices, const std::vector<uint32_t>& order)
+        {
+            std::vector<uint32_t> source(indices, indices + order.size() * 3);
+            for (size_t i = 0; i < order.size(); ++i)
+                std::copy_n(&source[order[i] * 3], 3, &indices[i * 3]);
+        }
+    }
+
+    float ComputeAcmr(const uint32_t* indices, const size_t index_count, const uint32_t cache_size)
+    {
+        if (index_count < 3) return 0.0f;
+
+        VertexCache cache(*std::max_element(indices, indices + index_count) + 1, cache_size);
+        size_t misses = 0;
+        for (size_t i = 0; i < index_count; ++i)
+            misses += cache.Miss(indices[i]);
+        return static_cast<float>(misses) / static_cast<float>(index_count / 3);
+    }
+
+    size_t OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const float acmr_threshold)
+    {
+        const size_t triangle_count = indices.size() / 3;
+        if (triangle_count == 0) return 0;
+
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> hard_starts;
+        Tipsify(indices.data(), indices.size(), order, hard_starts);
+        ApplyOrder(indices.data(), order);
+        hard_starts.push_back(static_cast<uint32_t>(triangle_count));
+
+        // Split hard clusters wherever a fresh start costs little: the cache is emptied at every
+        // split, so each piece's ACMR is what it would be wherever the sort puts it
+        const float max_acmr = ComputeAcmr(indices.data(), indices.size()) * acmr_threshold;
+        VertexCache cache(vertices.size(), k_vertex_cache_size);
+        std::vector<uint32_t> cluster_starts;
+        for (size_t h = 0; h + 1 < hard_starts.size(); ++h) {
+            const uint32_t end = hard_starts[h + 1];
+            uint32_t begin = hard_starts[h];
+            cluster_starts.push_back(begin);
+            cache.Reset();
+
+            size_t misses = 0;
+            for (uint32_t t = begin; t < end; ++t) {
+                for (int c = 0; c < 3; ++c) misses += cache.Miss(indices[t * 3 + c]);
+
+                const uint32_t length = t + 1 - begin;
+                if (length >= k_min_cluster_triangles && t + 1 < end &&
+                    static_cast<float>(misses) <= max_acmr * static_cast<float>(length)) {
+                    begin = t + 1;
+                    cluster_starts.push_back(begin);
+                    cache.Reset();
+                    misses = 0;
+                }
+            }
+        }
+        const size_t cluster_count = cluster_starts.size();
+        cluster_starts.push_back(static_cast<uint32_t>(triangle_count));
+
+        // Area-weighted centroid and facing of each cluster, and of the whole mesh
+        std::vector<glm::vec3> centroids(cluster_count, glm::vec3(0.0f));
+        std::vector<glm::vec3> normals(cluster_count, glm::vec3(0.0f));
+        std::vector<float> areas(cluster_count, 0.0f);
+        glm::vec3 mesh_centroid(0.0f);
+        float mesh_area = 0.0f;
+        for (size_t c = 0; c < cluster_count; ++c) {
+            for (uint32_t t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t) {
+                const glm::vec3& p0 = vertices[indices[t * 3]].pos;
+                const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+                const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+
+                centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            mesh_centroid += centroids[c];
+            mesh_area += areas[c];
+        }
+        if (mesh_area > 0.0f) mesh_centroid /= mesh_area;
+
+        // Clusters further out along their own facing are more likely to occlude the others
+        std::vector<float> outwardness(cluster_count, 0.0f);
+        for (size_t c = 0; c < cluster_count; ++c) {
+            const float normal_length = glm::length(normals[c]);
+            if (areas[c] <= 0.0f || normal_length <= 0.0f) continue;
+            outwardness[c] = glm::dot(centroids[c] / areas[c] - mesh_centroid, normals[c] / normal_length);
+        }
+
+        std::vector<uint32_t> cluster_order(cluster_count);
+        std::iota(cluster_order.begin(), cluster_order.end(), 0u);
+        std::stable_sort(cluster_order.begin(), cluster_order.end(),
+                         [&](const uint32_t a, const uint32_t b) { return outwardness[a] > outwardness[b]; });
+
+        order.clear();
+        for (const uint32_t c : cluster_order)
+            for (uint32_t t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t)
+                order.push_back(t);
+        ApplyOrder(indices.data(), order);
+
+        return cluster_count;
+    }
+
+    void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                             std::vector<std::vector<uint32_t>>& lod_indices)
+    {
+        constexpr uint32_t k_unused = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(vertices.size(), k_unused);
+        uint32_t next = 0;
+
+        const auto renumber = [&](std::vector<uint32_t>& list) {
+            for (uint32_t& index : list) {
+                if (remap[index] == k_unused) remap[index] = next++;
+                index = remap[index];
+            }
+        };
+        renumber(indices);
+        for (auto& level : lod_indices) renumber(level);
+
+        std::vector<Vertex> reordered(next);
+        for (size_t v = 0; v < vertices.size(); ++v)
+            if (remap[v] != k_unused) reordered[remap[v]] = vertices[v];
+        vertices = std::move(reordered);
+    }
+}
@@ -0,0 +1,293 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <unordered_map>
+
+// Hex
+#include "Renderer/Data/MeshSimplifier.h"
+#include "Renderer/Data/Mesh.h"
+
+namespace Hex
+{
+    // Levels with fewer triangles than this are not worth a draw command of their own
+    static constexpr size_t k_min_lod_triangles = 64;
+    // Each level has to drop at least this share of the previous level's triangles
+    static constexpr float k_min_lod_reduction = 0.2f;
+    // Collapses that turn a surviving triangle's normal further than this (as a cosine) are rejected
+    static constexpr double k_min_normal_cosine = 0.25;
+
+    namespace
+    {
+        // Symmetric 4x4 matrix whose p^T Q p is the area-weighted sum of squared distances from p to a set of planes
+        struct Quadric
+        {
+            double a00{0}, a01{0}, a02{0}, a03{0};
+            double a11{0}, a12{0}, a13{0};
+            double a22{0}, a23{0};
+            double a33{0};
+
+            static Quadric FromPlane(const glm::dvec3& n, const double d, const double weight)
+            {
+                Quadric q;
+                q.a00 = weight * n.x * n.x; q.a01 = weight * n.x * n.y; q.a02 = weight * n.x * n.z; q.a03 = weight * n.x * d;
+                q.a11 = weight * n.y * n.y; q.a12 = weight * n.y * n.z; q.a13 = weight * n.y * d;
+                q.a22 = weight * n.z * n.z; q.a23 = weight * n.z * d;
+                q.a33 = weight * d * d;
+                return q;
+            }
+
+            Quadric& operator+=(const Quadric& o)
+            {
+                a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+                a11 += o.a11; a12 += o.a12; a13 += o.a13;
+                a22 += o.a22; a23 += o.a23;
+                a33 += o.a33;
+                return *this;
+            }
+
+            [[nodiscard]] double Evaluate(const glm::dvec3& p) const
+            {
+                return a00 * p.x * p.x + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a03 * p.x)
+                     + a11 * p.y * p.y + 2.0 * (a12 * p.y * p.z + a13 * p.y)
+                     + a22 * p.z * p.z + 2.0 * a23 * p.z
+                     + a33;
+            }
+        };
+
+        // Exact bit pattern of a position, for welding vertices that only differ in their attributes
+        struct PositionKey
+        {
+            uint32_t x, y, z;
+
+            static PositionKey From(const glm::vec3& p)
+            {
+                return { std::bit_cast<uint32_t>(p.x), std::bit_cast<uint32_t>(p.y), std::bit_cast<uint32_t>(p.z) };
+            }
+
+            bool operator==(const PositionKey&) const = default;
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const PositionKey& key) const
+            {
+                return (static_cast<size_t>(key.x) * 73856093u) ^ (static_cast<size_t>(key.y) * 19349663u) ^ (static_cast<size_t>(key.z) * 83492791u);
+            }
+        };
+
+        // Merge position `from` into its neighbour `to`
+        struct Collapse
+        {
+            double cost;
+            uint32_t from;
+            uint32_t to;
+        };
+
+        uint64_t EdgeKey(uint32_t a, uint32_t b)
+        {
+            if (a > b) std::swap(a, b);
+            return (static_cast<uint64_t>(a) << 32) | b;
+        }
+    }
+
+    std::vector<uint32_t> SimplifyMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                       const size_t target_index_count)
+    {
+        std::vector<uint32_t> result = indices;
+        if (result.size() <= target_index_count || vertices.empty()) return result;
+
+        const auto vertex_count = static_cast<uint32_t>(vertices.size());
+
+        // Collapses work on positions; each position is named after the first vertex found at it
+        std::vector<uint32_t> position_of(vertex_count);
+        std::vector<uint32_t> wedge_count(vertex_count, 0);
+        {
+            std::unordered_map<PositionKey, uint32_t, PositionHash> first_at;
+            first_at.reserve(vertex_count);
+            for (uint32_t v = 0; v < vertex_count; ++v) {
+                const auto it = first_at.emplace(PositionKey::From(vertices[v].pos), v).first;
+                position_of[v] = it->second;
+                ++wedge_count[it->second];
+            }
+        }
+
+        const auto position = [&vertices](const uint32_t p) { return glm::dvec3(vertices[p].pos); };
+
+        // Every triangle's plane goes into the quadrics of its three corners
+        std::vector<Quadric> quadrics(vertex_count);
+        std::unordered_map<uint64_t, uint32_t> edge_uses;
+        for (size_t t = 0; t + 2 < result.size(); t += 3) {
+            const uint32_t p0 = position_of[result[t]], p1 = position_of[result[t + 1]], p2 = position_of[result[t + 2]];
+            const glm::dvec3 normal = glm::cross(position(p1) - position(p0), position(p2) - position(p0));
+            if (const double length = glm::length(normal); length > 0.0) {
+                const glm::dvec3 n = normal / length;
+                const Quadric q = Quadric::FromPlane(n, -glm::dot(n, position(p0)), length * 0.5);
+                quadrics[p0] += q; quadrics[p1] += q; quadrics[p2] += q;
+            }
+            ++edge_uses[EdgeKey(p0, p1)];
+            ++edge_uses[EdgeKey(p1, p2)];
+            ++edge_uses[EdgeKey(p2, p0)];
+        }
+
+        // Seams (several vertices at one position) and open or non-manifold edges would tear if they moved
+        std::vector<uint8_t> locked(vertex_count, 0);
+        for (uint32_t v = 0; v < vertex_count; ++v)
+            if (wedge_count[position_of[v]] > 1) locked[position_of[v]] = 1;
+        for (const auto& [edge, uses] : edge_uses) {
+            if (uses == 2) continue;
+            locked[static_cast<uint32_t>(edge >> 32)] = 1;
+            locked[static_cast<uint32_t>(edge)] = 1;
+        }
+
+        std::vector<uint64_t> edges;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> ring_offsets;
+        std::vector<uint32_t> ring_triangles;
+        std::vector<uint32_t> collapse_to(vertex_count);
+        std::vector<uint32_t> target_vertex(vertex_count);
+        std::vector<uint8_t> touched(vertex_count);
+
+        // Each pass collapses the cheapest edges that don't share a neighbourhood, then rebuilds the index list
+        while (result.size() > target_index_count) {
+            const size_t triangle_count = result.size() / 3;
+
+            edges.clear();
+            for (size_t t = 0; t < triangle_count; ++t)
+                for (int i = 0; i < 3; ++i)
+                    edges.push_back(EdgeKey(position_of[result[t * 3 + i]], position_of[result[t * 3 + (i + 1) % 3]]));
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            // Cheaper direction of every edge that can collapse at all; the merged quadric is what the kept position carries on
+            collapses.clear();
+            for (const uint64_t edge : edges) {
+                const auto a = static_cast<uint32_t>(edge >> 32);
+                const auto b = static_cast<uint32_t>(edge);
+                Quadric merged = quadrics[a];
+                merged += quadrics[b];
+
+                Collapse best{ std::numeric_limits<double>::max(), a, a };
+                if (!locked[a]) best = { merged.Evaluate(position(b)), a, b };
+                if (!locked[b]) {
+                    const double cost = merged.Evaluate(position(a));
+                    if (cost < best.cost) best = { cost, b, a };
+                }
+                if (best.from != best.to) collapses.push_back(best);
+            }
+            if (collapses.empty()) break;
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) {
+                if (l.cost != r.cost) return l.cost < r.cost;
+                return l.from != r.from ? l.from < r.from : l.to < r.to;
+            });
+
+            // Triangles around each position, for the flip test
+            ring_offsets.assign(vertex_count + 1, 0);
+            for (const uint32_t index : result) ++ring_offsets[position_of[index] + 1];
+            std::partial_sum(ring_offsets.begin(), ring_offsets.end(), ring_offsets.begin());
+            ring_triangles.resize(result.size());
+            {
+                std::vector<uint32_t> cursor(ring_offsets.begin(), ring_offsets.end() - 1);
+                for (size_t corner = 0; corner < result.size(); ++corner)
+                    ring_triangles[cursor[position_of[result[corner]]]++] = static_cast<uint32_t>(corner / 3);
+            }
+
+            std::iota(collapse_to.begin(), collapse_to.end(), 0u);
+            std::fill(touched.begin(), touched.end(), uint8_t{0});
+
+            const size_t target_triangles = target_index_count / 3;
+            size_t remaining = triangle_count;
+            size_t applied = 0;
+
+            for (const Collapse& collapse : collapses) {
+                if (remaining <= target_triangles) break;
+                if (touched[collapse.from] || touched[collapse.to]) continue;
+
+                // Triangles on the edge disappear; every other one around `from` must keep facing the same way
+                size_t removed = 0;
+                uint32_t to_vertex = collapse.to;
+                bool flips = false;
+                for (uint32_t r = ring_offsets[collapse.from]; r < ring_offsets[collapse.from + 1] && !flips; ++r) {
+                    const uint32_t* corners = &result[static_cast<size_t>(ring_triangles[r]) * 3];
+                    glm::dvec3 p[3];
+                    glm::dvec3 moved[3];
+                    bool on_edge = false;
+                    for (int i = 0; i < 3; ++i) {
+                        const uint32_t pos = position_of[corners[i]];
+                        if (pos == collapse.to) { on_edge = true; to_vertex = corners[i]; }
+                        p[i] = position(pos);
+                        moved[i] = pos == collapse.from ? position(collapse.to) : p[i];
+                    }
+                    if (on_edge) { ++removed; continue; }
+
+                    const glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    const glm::dvec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                    const double before_length = glm::length(before);
+                    const double after_length = glm::length(after);
+                    if (before_length == 0.0) continue;
+                    flips = after_length == 0.0 || glm::dot(before, after) < k_min_normal_cosine * before_length * after_length;
+                }
+                if (flips || removed == 0) continue;
+
+                collapse_to[collapse.from] = collapse.to;
+                target_vertex[collapse.from] = to_vertex;
+                quadrics[collapse.to] += quadrics[collapse.from];
+
+                // Nothing next to this collapse may move again this pass, or its flip test would be stale
+                touched[collapse.from] = touched[collapse.to] = 1;
+                for (uint32_t r = ring_offsets[collapse.from]; r < ring_offsets[collapse.from + 1]; ++r)
+                    for (int i = 0; i < 3; ++i)
+                        touched[position_of[result[static_cast<size_t>(ring_triangles[r]) * 3 + i]]] = 1;
+
+                remaining -= std::min(removed, remaining);
+                ++applied;
+            }
+            if (applied == 0) break;
+
+            // Collapsed positions are never seams, so they have exactly one vertex to redirect
+            size_t write = 0;
+            for (size_t t = 0; t < triangle_count; ++t) {
+                uint32_t corners[3];
+                for (int i = 0; i < 3; ++i) {
+                    const uint32_t index = result[t * 3 + i];
+                    const uint32_t pos = position_of[index];
+                    corners[i] = collapse_to[pos] != pos ? target_vertex[pos] : index;
+                }
+
+                const uint32_t p0 = position_of[corners[0]], p1 = position_of[corners[1]], p2 = position_of[corners[2]];
+                if (p0 == p1 || p1 == p2 || p2 == p0) continue;
+
+                result[write++] = corners[0];
+                result[write++] = corners[1];
+                result[write++] = corners[2];
+            }
+            result.resize(write);
+        }
+
+        return result;
+    }
+
+    std::vector<std::vector<uint32_t>> BuildLodChain(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                                     const size_t max_levels)
+    {
+        std::vector<std::vector<uint32_t>> levels;
+        levels.reserve(max_levels); // `previous` points into it
+
+        const std::vector<uint32_t>* previous = &indices;
+        while (levels.size() < max_levels) {
+            const size_t target_triangles = previous->size() / 3 / 2;
+            if (target_triangles < k_min_lod_triangles) break;
+
+            std::vector<uint32_t> level = SimplifyMesh(vertices, *previous, target_triangles * 3);
+            if (static_cast<float>(level.size()) > static_cast<float>(previous->size()) * (1.0f - k_min_lod_reduction)) break;
+
+            levels.push_back(std::move(level));
+            previous = &levels.back();
+        }
+
+        return levels;
+    }
+}
@@ -0,0 +1,168 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+// Hex
+#include "Renderer/Data/Meshlet.h"
+#include "Renderer/Data/Mesh.h"
+
+namespace Hex
+{
+    // Bounding sphere around the meshlet's vertices, and the narrowest cone around its triangles' mean normal
+    static void ComputeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                     const std::vector<uint32_t>& meshlet_vertices, Meshlet& meshlet)
+    {
+        glm::vec3 min = vertices[meshlet_vertices.front()].pos;
+        glm::vec3 max = min;
+        for (const uint32_t v : meshlet_vertices) {
+            min = glm::min(min, vertices[v].pos);
+            max = glm::max(max, vertices[v].pos);
+        }
+
+        meshlet.center = (min + max) * 0.5f;
+        for (const uint32_t v : meshlet_vertices)
+            meshlet.radius = std::max(meshlet.radius, glm::length(vertices[v].pos - meshlet.center));
+
+        const auto normal_of = [&](const uint32_t first) {
+            const glm::vec3& p0 = vertices[indices[first]].pos;
+            const glm::vec3 n = glm::cross(vertices[indices[first + 1]].pos - p0, vertices[indices[first + 2]].pos - p0);
+            const float length = glm::length(n);
+            return length > 0.0f ? n / length : glm::vec3(0.0f);
+        };
+
+        glm::vec3 axis(0.0f);
+        for (uint32_t i = meshlet.first_index; i < meshlet.first_index + meshlet.index_count; i += 3)
+            axis += normal_of(i);
+
+        // Triangles facing every which way (a closed little cap, say) leave no usable cone
+        const float axis_length = glm::length(axis);
+        if (axis_length < 1e-4f) return;
+        meshlet.cone_axis = axis / axis_length;
+
+        float cutoff = 1.0f;
+        for (uint32_t i = meshlet.first_index; i < meshlet.first_index + meshlet.index_count; i += 3)
+            if (const glm::vec3 n = normal_of(i); n != glm::vec3(0.0f))
+                cutoff = std::min(cutoff, glm::dot(n, meshlet.cone_axis));
+        meshlet.cone_cutoff = cutoff;
+    }
+
+    // True when every edge is shared by exactly two triangles wound opposite ways, with vertices split on
+    // UV or normal seams welded back together by position. Only then is each back face hidden behind a
+    // front face, so skipping back-facing clusters can't change the picture while the colour pass
+    // draws both sides.
+    static bool IsClosed(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint32_t> order(vertices.size());
+        std::iota(order.begin(), order.end(), 0u);
+        const auto less = [&](const uint32_t a, const uint32_t b) {
+            const glm::vec3& pa = vertices[a].pos;
+            const glm::vec3& pb = vertices[b].pos;
+            return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), less);
+
+        std::vector<uint32_t> welded(vertices.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            welded[order[i]] = i > 0 && vertices[order[i]].pos == vertices[order[i - 1]].pos ? welded[order[i - 1]] : order[i];
+
+        // +1 per directed edge, -1 per edge the other way round: a closed mesh cancels out everywhere
+        std::unordered_map<uint64_t, int32_t> edges;
+        edges.reserve(indices.size());
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            for (int i = 0; i < 3; ++i) {
+                const uint32_t a = welded[indices[t + i]];
+                const uint32_t b = welded[indices[t + (i + 1) % 3]];
+                if (a == b) continue;
+                const uint64_t key = a < b ? (uint64_t(a) << 32 | b) : (uint64_t(b) << 32 | a);
+                edges[key] += a < b ? 1 : -1;
+            }
+        }
+        return std::all_of(edges.begin(), edges.end(), [](const auto& edge) { return edge.second == 0; });
+    }
+
+    std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        const size_t triangle_count = indices.size() / 3;
+        if (triangle_count <= k_meshlet_max_triangles) return {};
+
+        const auto vertex_count = static_cast<uint32_t>(vertices.size());
+
+        // Triangles around each vertex
+        std::vector<uint32_t> ring_offsets(vertex_count + 1, 0);
+        for (const uint32_t index : indices) ++ring_offsets[index + 1];
+        for (uint32_t v = 0; v < vertex_count; ++v) ring_offsets[v + 1] += ring_offsets[v];
+        std::vector<uint32_t> ring_triangles(indices.size());
+        {
+            std::vector<uint32_t> cursor(ring_offsets.begin(), ring_offsets.end() - 1);
+            for (size_t corner = 0; corner < indices.size(); ++corner)
+                ring_triangles[cursor[indices[corner]]++] = static_cast<uint32_t>(corner / 3);
+        }
+
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> ordered;
+        ordered.reserve(indices.size());
+
+        std::vector<uint8_t> emitted(triangle_count, 0);
+        std::vector<uint32_t> owner(vertex_count, std::numeric_limits<uint32_t>::max()); // meshlet a vertex was last added to
+        std::vector<uint32_t> meshlet_vertices;
+        size_t seed = 0;
+
+        while (true) {
+            while (seed < triangle_count && emitted[seed]) ++seed;
+            if (seed == triangle_count) break;
+
+            const auto id = static_cast<uint32_t>(meshlets.size());
+            Meshlet meshlet;
+            meshlet.first_index = static_cast<uint32_t>(ordered.size());
+            meshlet_vertices.clear();
+
+            const auto new_vertices = [&](const size_t triangle) {
+                uint32_t count = 0;
+                for (int i = 0; i < 3; ++i) count += owner[indices[triangle * 3 + i]] != id;
+                return count;
+            };
+
+            // Grow from the seed, always taking the neighbouring triangle that adds the fewest vertices
+            size_t next = seed;
+            while (true) {
+                emitted[next] = 1;
+                for (int i = 0; i < 3; ++i) {
+                    const uint32_t v = indices[next * 3 + i];
+                    ordered.push_back(v);
+                    if (owner[v] != id) { owner[v] = id; meshlet_vertices.push_back(v); }
+                }
+                meshlet.index_count += 3;
+                if (meshlet.index_count / 3 == k_meshlet_max_triangles) break;
+
+                size_t best = triangle_count;
+                uint32_t best_new = 4;
+                for (const uint32_t v : meshlet_vertices) {
+                    for (uint32_t r = ring_offsets[v]; r < ring_offsets[v + 1] && best_new > 0; ++r) {
+                        const uint32_t t = ring_triangles[r];
+                        if (emitted[t]) continue;
+                        const uint32_t added = new_vertices(t);
+                        if (meshlet_vertices.size() + added > k_meshlet_max_vertices) continue;
+                        if (added < best_new || (added == best_new && t < best)) { best = t; best_new = added; }
+                    }
+                    if (best_new == 0) break;
+                }
+                if (best == triangle_count) break;
+                next = best;
+            }
+
+            ComputeMeshletBounds(vertices, ordered, meshlet_vertices, meshlet);
+            meshlets.push_back(meshlet);
+        }
+
+        // Open meshes (ground planes, cards) show their back faces, so their clusters never cone-cull
+        if (!IsClosed(vertices, indices))
+            for (Meshlet& meshlet : meshlets) meshlet.cone_cutoff = -1.0f;
+
+        indices = std::move(ordered);
+        return meshlets;
+    }
+}
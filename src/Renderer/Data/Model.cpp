@@ -5,7 +5,7 @@
 
 namespace Hex
 {
-    Model::Model(const std::string &path)
+    Model::Model(const std::string &path, const VertexFormat format)
     {
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(
@@ -26,7 +26,7 @@ namespace Hex
         for (unsigned i = 0; i < scene->mNumMeshes; ++i)
         {
             // This will either load + cache, or return the existing one.
-            auto meshPtr = ResourceManager::LoadMesh(path, i);
+            auto meshPtr = ResourceManager::LoadMesh(path, i, format);
             meshes.push_back(meshPtr);
         }
     }
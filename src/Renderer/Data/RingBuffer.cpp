@@ -0,0 +1,154 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <format>
+
+// Hex
+#include "Renderer/Data/RingBuffer.h"
+
+namespace Hex
+{
+    static GLsizeiptr AlignUp(const GLsizeiptr value, const GLsizeiptr alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    RingBuffer::RingBuffer(const GLsizeiptr frame_capacity)
+    {
+        CreateStorage(frame_capacity);
+    }
+
+    RingBuffer::~RingBuffer()
+    {
+        DestroyStorage();
+    }
+
+    void RingBuffer::CreateStorage(const GLsizeiptr frame_capacity)
+    {
+        // Keep every region start 256-byte aligned so offsets stay valid for any binding target
+        m_frame_capacity = AlignUp(frame_capacity, 256);
+
+        m_buffer = CreateMappedBuffer(m_frame_capacity * k_frames_in_flight, m_mapped);
+    }
+
+    GLuint RingBuffer::CreateMappedBuffer(const GLsizeiptr size, uint8_t*& mapped)
+    {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (!mapped)
+            Log(LogLevel::Error, "RingBuffer: failed to persistently map upload buffer");
+        return buffer;
+    }
+
+    void RingBuffer::DestroyStorage()
+    {
+        for (auto& fence : m_fences)
+        {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+        for (auto& buffers : m_overflow)
+        {
+            if (!buffers.empty()) glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+            buffers.clear();
+        }
+
+        // Deleting a mapped buffer unmaps it; the GL keeps the storage alive for any draws still in flight
+        if (m_buffer) glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        m_mapped = nullptr;
+    }
+
+    void RingBuffer::BeginFrame()
+    {
+        m_stats = {};
+
+        // Regrow between frames so no name handed out during a frame ever goes away. Regions still
+        // in flight keep reading the old storage; the GL frees it once they are done.
+        if (m_overflow_bytes > 0)
+        {
+            const GLsizeiptr needed = std::max(m_frame_capacity * 2, AlignUp(m_frame_capacity + m_overflow_bytes, 256));
+            Log(LogLevel::Warning, std::format("RingBuffer: growing frame region {} -> {} bytes",
+                m_frame_capacity, needed));
+
+            DestroyStorage();
+            CreateStorage(needed);
+            ++m_stats.reallocations;
+            m_overflow_bytes = 0;
+        }
+
+        m_frame_index = (m_frame_index + 1) % k_frames_in_flight;
+        m_head = 0;
+
+        GLsync& fence = m_fences[m_frame_index];
+        if (!fence) return;
+
+        // Poll first; only flush and block if the GPU really is still reading this region
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+        {
+            ++m_stats.stalls_avoided;
+        }
+        else
+        {
+            ++m_stats.stalls;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 ms
+            } while (result == GL_TIMEOUT_EXPIRED);
+
+            if (result == GL_WAIT_FAILED)
+                Log(LogLevel::Error, "RingBuffer: glClientWaitSync failed");
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+
+        std::vector<GLuint>& overflow = m_overflow[m_frame_index];
+        if (!overflow.empty()) glDeleteBuffers(static_cast<GLsizei>(overflow.size()), overflow.data());
+        overflow.clear();
+    }
+
+    void RingBuffer::EndFrame()
+    {
+        GLsync& fence = m_fences[m_frame_index];
+        if (fence) glDeleteSync(fence);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    RingBuffer::Allocation RingBuffer::Allocate(const GLsizeiptr size, const GLsizeiptr alignment)
+    {
+        const GLsizeiptr region_start = m_frame_capacity * m_frame_index;
+        GLsizeiptr offset = AlignUp(region_start + m_head, alignment);
+
+        if (offset + size > region_start + m_frame_capacity)
+            return AllocateOverflow(size);
+
+        m_head = offset + size - m_frame_capacity * m_frame_index;
+        m_stats.bytes_uploaded += static_cast<uint64_t>(size);
+
+        return { m_mapped + offset, offset, m_buffer };
+    }
+
+    RingBuffer::Allocation RingBuffer::AllocateOverflow(const GLsizeiptr size)
+    {
+        // Out of room for this frame: the ring's name may already be bound or cached by earlier passes,
+        // so this allocation gets a buffer of its own, released with the region at its next BeginFrame
+        uint8_t* mapped = nullptr;
+        const GLuint buffer = CreateMappedBuffer(size, mapped);
+        m_overflow[m_frame_index].push_back(buffer);
+
+        m_overflow_bytes += AlignUp(size, 256);
+        m_stats.bytes_uploaded += static_cast<uint64_t>(size);
+        ++m_stats.overflows;
+
+        return { mapped, 0, buffer };
+    }
+}
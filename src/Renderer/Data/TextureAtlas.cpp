@@ -0,0 +1,177 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+// Hex
+#include "Renderer/Data/TextureAtlas.h"
+#include "Renderer/Data/Texture.h"
+#include "Renderer/GLState.h"
+
+namespace Hex
+{
+    std::unique_ptr<TextureAtlas> TextureAtlas::s_instance{nullptr};
+
+    // Layers a new page starts with; pages double from there up to the driver's limit
+    static constexpr uint32_t k_initial_page_layers = 4;
+
+    void TextureAtlas::Init()
+    {
+        s_instance = std::make_unique<TextureAtlas>();
+    }
+
+    void TextureAtlas::Shutdown()
+    {
+        s_instance.reset();
+    }
+
+    TextureAtlas::TextureAtlas()
+    {
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &m_max_layers);
+        glGenBuffers(1, &m_record_buffer);
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+        for (const Page& page : m_pages)
+        {
+            GLState::ForgetTexture(page.texture);
+            glDeleteTextures(1, &page.texture);
+        }
+        glDeleteBuffers(1, &m_record_buffer);
+    }
+
+    bool TextureAtlas::Add(Texture& texture, const GLenum internal_format, const int width, const int height)
+    {
+        // Same chain glGenerateMipmap builds for the source
+        const int levels = static_cast<int>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+        auto page_index = static_cast<uint32_t>(m_pages.size());
+        for (uint32_t i = 0; i < m_pages.size(); ++i)
+        {
+            const Page& page = m_pages[i];
+            if (page.format == internal_format && page.width == width && page.height == height
+                && page.layer_count < static_cast<uint32_t>(m_max_layers))
+            {
+                page_index = i;
+                break;
+            }
+        }
+
+        if (page_index == m_pages.size())
+        {
+            Page page;
+            page.format = internal_format;
+            page.width = width;
+            page.height = height;
+            page.levels = levels;
+            GrowPage(page, std::min(k_initial_page_layers, static_cast<uint32_t>(m_max_layers)));
+            m_pages.push_back(page);
+            Log(LogLevel::Info, std::format("Texture atlas: new {}x{} page", width, height));
+        }
+
+        Page& page = m_pages[page_index];
+        if (page.layer_count == page.capacity)
+            GrowPage(page, std::min(page.capacity * 2, static_cast<uint32_t>(m_max_layers)));
+        if (page.layer_count == page.capacity)
+        {
+            Log(LogLevel::Warning, std::format("Texture atlas: no room for a {}x{} texture", width, height));
+            return false;
+        }
+
+        const uint32_t layer = page.layer_count++;
+        for (int level = 0; level < levels; ++level)
+        {
+            glCopyImageSubData(texture.GetID(), GL_TEXTURE_2D, level, 0, 0, 0,
+                               page.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(layer),
+                               std::max(width >> level, 1), std::max(height >> level, 1), 1);
+        }
+
+        texture.SetAtlasSlot(page_index, layer);
+        return true;
+    }
+
+    void TextureAtlas::GrowPage(Page& page, const uint32_t capacity) const
+    {
+        if (capacity <= page.capacity) return;
+
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, page.levels, page.format, page.width, page.height, static_cast<GLsizei>(capacity));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Layers already handed out keep their index; the whole chain moves across on the GPU
+        if (page.texture)
+        {
+            for (int level = 0; level < page.levels; ++level)
+            {
+                glCopyImageSubData(page.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   std::max(page.width >> level, 1), std::max(page.height >> level, 1),
+                                   static_cast<GLsizei>(page.layer_count));
+            }
+            GLState::ForgetTexture(page.texture);
+            glDeleteTextures(1, &page.texture);
+        }
+
+        page.texture = texture;
+        page.capacity = capacity;
+    }
+
+    uint32_t TextureAtlas::AddMaterial(const MaterialRecord& record)
+    {
+        m_records.push_back(record);
+        m_records_dirty = true;
+        return static_cast<uint32_t>(m_records.size() - 1);
+    }
+
+    const TextureAtlas::Binding* TextureAtlas::InternBinding(const Binding& binding)
+    {
+        const auto it = std::find(m_bindings.begin(), m_bindings.end(), binding);
+        if (it != m_bindings.end()) return &*it;
+        return &m_bindings.emplace_back(binding);
+    }
+
+    void TextureAtlas::Bind(const Binding& binding) const
+    {
+        for (GLuint unit = 0; unit < k_material_map_count; ++unit)
+        {
+            const uint32_t page = binding.pages[unit];
+            GLState::BindTexture(unit, GL_TEXTURE_2D_ARRAY, page == k_no_page ? 0 : m_pages[page].texture);
+        }
+    }
+
+    void TextureAtlas::BindMaterialRecords()
+    {
+        // Records only change while materials load, so a full re-upload is fine
+        if (m_records_dirty && !m_records.empty())
+        {
+            const auto size = static_cast<GLsizeiptr>(m_records.size() * sizeof(MaterialRecord));
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_record_buffer);
+            if (m_records.size() > m_record_capacity)
+            {
+                m_record_capacity = std::max(m_records.size(), m_record_capacity * 2);
+                glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(m_record_capacity * sizeof(MaterialRecord)), nullptr, GL_STATIC_DRAW);
+            }
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, m_records.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            m_records_dirty = false;
+        }
+
+        if (m_record_capacity > 0)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_material_records_binding, m_record_buffer);
+    }
+
+    uint32_t TextureAtlas::GetLayerCount() const
+    {
+        uint32_t layers = 0;
+        for (const Page& page : m_pages) layers += page.layer_count;
+        return layers;
+    }
+}
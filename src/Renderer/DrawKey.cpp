@@ -0,0 +1,105 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+
+// Hex
+#include "Renderer/DrawKey.h"
+
+namespace Hex
+{
+	namespace
+	{
+		constexpr uint32_t k_depth_shift = 0;
+		constexpr uint32_t k_mesh_shift = k_depth_shift + DrawKey::k_depth_bits;
+		constexpr uint32_t k_material_shift = k_mesh_shift + DrawKey::k_mesh_bits;
+		constexpr uint32_t k_group_shift = k_material_shift + DrawKey::k_material_bits;
+		constexpr uint32_t k_shader_shift = k_group_shift + DrawKey::k_group_bits;
+		constexpr uint32_t k_pass_shift = k_shader_shift + DrawKey::k_shader_bits;
+		constexpr uint32_t k_layout_shift = k_pass_shift + 1;
+		static_assert(k_layout_shift + 2 == 64, "draw key fields must fill 64 bits");
+
+		constexpr uint64_t Field(const uint32_t value, const uint32_t bits, const uint32_t shift)
+		{
+			return (static_cast<uint64_t>(value) & ((1ull << bits) - 1)) << shift;
+		}
+	}
+
+	uint64_t DrawKey::Pack(const uint32_t layout, const DrawPass pass, const uint32_t shader, const uint32_t group,
+						   const uint32_t material, const uint32_t mesh, const uint32_t depth)
+	{
+		return Field(layout, 2, k_layout_shift)
+			 | Field(static_cast<uint32_t>(pass), 1, k_pass_shift)
+			 | Field(shader, k_shader_bits, k_shader_shift)
+			 | Field(group, k_group_bits, k_group_shift)
+			 | Field(material, k_material_bits, k_material_shift)
+			 | Field(mesh, k_mesh_bits, k_mesh_shift)
+			 | Field(depth, k_depth_bits, k_depth_shift);
+	}
+
+	uint32_t DrawKey::QuantiseDepth(const float view_depth, const float near_plane, const float far_plane)
+	{
+		constexpr float k_max = static_cast<float>((1u << k_depth_bits) - 1);
+		if (view_depth <= near_plane) return 0;
+		if (view_depth >= far_plane) return static_cast<uint32_t>(k_max);
+
+		const float t = std::log(view_depth / near_plane) / std::log(far_plane / near_plane);
+		return static_cast<uint32_t>(t * k_max);
+	}
+
+	uint32_t DrawKeyIds::Get(const void* object)
+	{
+		if (!object) return 0;
+
+		const auto [it, inserted] = m_ids.try_emplace(object, 0);
+		if (inserted)
+		{
+			it->second = std::min(static_cast<uint32_t>(m_ids.size()), m_limit);
+			if (it->second == m_limit && !m_warned)
+			{
+				Log(LogLevel::Warning, std::format("Draw key: more than {} objects in one field, sharing IDs from here on", m_limit - 1));
+				m_warned = true;
+			}
+		}
+		return it->second;
+	}
+
+	void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+	{
+		if (items.size() < 2) return;
+
+		// Bits that differ between any two keys; bytes without any are already sorted
+		uint64_t varying = 0;
+		const uint64_t first = items.front().key;
+		for (const SortItem& item : items) varying |= item.key ^ first;
+
+		scratch.resize(items.size());
+		std::vector<SortItem>* source = &items;
+		std::vector<SortItem>* destination = &scratch;
+
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			if (((varying >> shift) & 0xFF) == 0) continue;
+
+			std::array<uint32_t, 256> offsets{};
+			for (const SortItem& item : *source) ++offsets[(item.key >> shift) & 0xFF];
+
+			uint32_t sum = 0;
+			for (uint32_t& offset : offsets)
+			{
+				const uint32_t count = offset;
+				offset = sum;
+				sum += count;
+			}
+
+			for (const SortItem& item : *source) (*destination)[offsets[(item.key >> shift) & 0xFF]++] = item;
+			std::swap(source, destination);
+		}
+
+		// An odd number of passes leaves the result in the scratch buffer
+		if (source != &items) items.swap(scratch);
+	}
+}
@@ -0,0 +1,251 @@
+#include "pch.h"
+
+// STL
+#include <cstring>
+
+// Hex
+#include "Renderer/GLState.h"
+
+namespace Hex
+{
+	GLuint GLState::s_program = k_unknown;
+	GLuint GLState::s_vao = k_unknown;
+	GLuint GLState::s_draw_framebuffer = k_unknown;
+	GLuint GLState::s_read_framebuffer = k_unknown;
+	GLuint GLState::s_active_unit = k_unknown;
+	std::array<std::array<GLuint, GLState::k_texture_targets>, GLState::k_texture_units> GLState::s_textures = [] {
+		std::array<std::array<GLuint, k_texture_targets>, k_texture_units> textures{};
+		for (auto& unit : textures) unit.fill(k_unknown);
+		return textures;
+	}();
+	std::array<GLint, 4> GLState::s_viewport{ -1, -1, -1, -1 };
+	std::array<GLState::BufferRange, GLState::k_uniform_buffer_bindings> GLState::s_uniform_buffers = [] {
+		std::array<BufferRange, k_uniform_buffer_bindings> ranges{};
+		ranges.fill({ k_unknown, 0, 0 });
+		return ranges;
+	}();
+	std::array<GLuint, GLState::k_capabilities> GLState::s_capabilities{ k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown };
+	GLuint GLState::s_cull_face = k_unknown;
+	GLuint GLState::s_depth_func = k_unknown;
+	GLuint GLState::s_depth_mask = k_unknown;
+	GLuint GLState::s_color_mask = k_unknown;
+	std::unordered_map<uint64_t, std::array<std::byte, GLState::k_max_uniform_size>> GLState::s_uniforms;
+	GLStateStats GLState::s_stats{};
+
+	int GLState::TargetIndex(const GLenum target)
+	{
+		switch (target)
+		{
+			case GL_TEXTURE_2D:             return 0;
+			case GL_TEXTURE_2D_ARRAY:       return 1;
+			case GL_TEXTURE_CUBE_MAP:       return 2;
+			case GL_TEXTURE_CUBE_MAP_ARRAY: return 3;
+			default:                        return -1;
+		}
+	}
+
+	int GLState::CapabilityIndex(const GLenum capability)
+	{
+		switch (capability)
+		{
+			case GL_DEPTH_TEST:          return 0;
+			case GL_CULL_FACE:           return 1;
+			case GL_DEPTH_CLAMP:         return 2;
+			case GL_POLYGON_OFFSET_FILL: return 3;
+			case GL_BLEND:               return 4;
+			case GL_SCISSOR_TEST:        return 5;
+			default:                     return -1;
+		}
+	}
+
+	bool GLState::Changed(GLuint& current, const GLuint value)
+	{
+		if (current == value)
+		{
+			++s_stats.state_skipped;
+			return false;
+		}
+		current = value;
+		++s_stats.state_issued;
+		return true;
+	}
+
+	void GLState::UseProgram(const GLuint program)
+	{
+		if (Changed(s_program, program)) glUseProgram(program);
+	}
+
+	void GLState::BindVertexArray(const GLuint vao)
+	{
+		if (Changed(s_vao, vao)) glBindVertexArray(vao);
+	}
+
+	void GLState::BindFramebuffer(const GLenum target, const GLuint framebuffer)
+	{
+		if (target == GL_FRAMEBUFFER)
+		{
+			if (s_draw_framebuffer == framebuffer && s_read_framebuffer == framebuffer)
+			{
+				++s_stats.state_skipped;
+				return;
+			}
+			s_draw_framebuffer = s_read_framebuffer = framebuffer;
+			++s_stats.state_issued;
+			glBindFramebuffer(target, framebuffer);
+			return;
+		}
+
+		GLuint& current = target == GL_READ_FRAMEBUFFER ? s_read_framebuffer : s_draw_framebuffer;
+		if (Changed(current, framebuffer)) glBindFramebuffer(target, framebuffer);
+	}
+
+	void GLState::ActiveTexture(const GLuint unit)
+	{
+		if (Changed(s_active_unit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+	}
+
+	void GLState::BindTexture(const GLuint unit, const GLenum target, const GLuint texture)
+	{
+		const int target_index = TargetIndex(target);
+		if (unit < k_texture_units && target_index >= 0 && s_textures[unit][target_index] == texture)
+		{
+			++s_stats.state_skipped;
+			return;
+		}
+
+		ActiveTexture(unit);
+		BindTexture(target, texture);
+	}
+
+	void GLState::BindTexture(const GLenum target, const GLuint texture)
+	{
+		const int target_index = TargetIndex(target);
+		if (s_active_unit < k_texture_units && target_index >= 0)
+		{
+			if (!Changed(s_textures[s_active_unit][target_index], texture)) return;
+		}
+		else
+		{
+			// Untracked unit or target: always goes through
+			++s_stats.state_issued;
+		}
+		glBindTexture(target, texture);
+	}
+
+	void GLState::Viewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+	{
+		const std::array<GLint, 4> viewport{ x, y, width, height };
+		if (viewport == s_viewport)
+		{
+			++s_stats.state_skipped;
+			return;
+		}
+		s_viewport = viewport;
+		++s_stats.state_issued;
+		glViewport(x, y, width, height);
+	}
+
+	void GLState::BindUniformBuffer(const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size)
+	{
+		const BufferRange range{ buffer, offset, size };
+		if (index < k_uniform_buffer_bindings)
+		{
+			if (s_uniform_buffers[index] == range)
+			{
+				++s_stats.state_skipped;
+				return;
+			}
+			s_uniform_buffers[index] = range;
+		}
+		++s_stats.state_issued;
+		glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+	}
+
+	void GLState::SetEnabled(const GLenum capability, const bool enabled)
+	{
+		const int index = CapabilityIndex(capability);
+		if (index >= 0 && !Changed(s_capabilities[index], enabled ? 1u : 0u)) return;
+		if (index < 0) ++s_stats.state_issued;
+
+		if (enabled)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+
+	void GLState::CullFace(const GLenum mode)
+	{
+		if (Changed(s_cull_face, mode)) glCullFace(mode);
+	}
+
+	void GLState::DepthFunc(const GLenum func)
+	{
+		if (Changed(s_depth_func, func)) glDepthFunc(func);
+	}
+
+	void GLState::DepthMask(const bool write)
+	{
+		if (Changed(s_depth_mask, write ? 1u : 0u)) glDepthMask(write ? GL_TRUE : GL_FALSE);
+	}
+
+	void GLState::ColorMask(const bool write)
+	{
+		const GLboolean mask = write ? GL_TRUE : GL_FALSE;
+		if (Changed(s_color_mask, write ? 1u : 0u)) glColorMask(mask, mask, mask, mask);
+	}
+
+	bool GLState::UniformChanged(const GLuint program, const GLint location, const void* value, const size_t size)
+	{
+		// Unknown uniforms (optimised out, misspelled) are a no-op in GL anyway
+		if (location < 0) return false;
+		if (size > k_max_uniform_size)
+		{
+			++s_stats.uniforms_issued;
+			return true;
+		}
+
+		const uint64_t key = (static_cast<uint64_t>(program) << 32) | static_cast<uint32_t>(location);
+		auto [it, inserted] = s_uniforms.try_emplace(key);
+		if (!inserted && std::memcmp(it->second.data(), value, size) == 0)
+		{
+			++s_stats.uniforms_skipped;
+			return false;
+		}
+
+		std::memcpy(it->second.data(), value, size);
+		++s_stats.uniforms_issued;
+		return true;
+	}
+
+	void GLState::ForgetTexture(const GLuint texture)
+	{
+		for (auto& unit : s_textures)
+			for (GLuint& bound : unit)
+				if (bound == texture) bound = 0;
+	}
+
+	void GLState::ForgetFramebuffer(const GLuint framebuffer)
+	{
+		if (s_draw_framebuffer == framebuffer) s_draw_framebuffer = 0;
+		if (s_read_framebuffer == framebuffer) s_read_framebuffer = 0;
+	}
+
+	void GLState::ForgetBuffer(const GLuint buffer)
+	{
+		for (BufferRange& range : s_uniform_buffers)
+			if (range.buffer == buffer) range = { 0, 0, 0 };
+	}
+
+	void GLState::Invalidate()
+	{
+		// Uniform values stay: they belong to the programs, which nothing else writes to
+		s_program = s_vao = k_unknown;
+		s_draw_framebuffer = s_read_framebuffer = k_unknown;
+		s_active_unit = k_unknown;
+		for (auto& unit : s_textures) unit.fill(k_unknown);
+		s_viewport = { -1, -1, -1, -1 };
+		s_uniform_buffers.fill({ k_unknown, 0, 0 });
+		s_capabilities.fill(k_unknown);
+		s_cull_face = s_depth_func = s_depth_mask = s_color_mask = k_unknown;
+	}
+}
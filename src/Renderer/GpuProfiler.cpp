@@ -0,0 +1,143 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <fstream>
+
+// Hex
+#include "Renderer/GpuProfiler.h"
+
+namespace Hex
+{
+	GpuProfiler::GpuProfiler()
+	{
+		for (Frame& frame : m_frames)
+			glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+	}
+
+	GpuProfiler::~GpuProfiler()
+	{
+		for (Frame& frame : m_frames)
+			glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+	}
+
+	void GpuProfiler::BeginFrame()
+	{
+		m_frame_index = (m_frame_index + 1) % k_latency;
+		Frame& frame = m_frames[m_frame_index];
+		if (frame.issued) Resolve(frame);
+
+		frame.count = 0;
+		frame.issued = true;
+		m_depth = 0;
+	}
+
+	uint32_t GpuProfiler::FindZone(const char* name)
+	{
+		for (uint32_t z = 0; z < m_zones.size(); ++z)
+			if (m_zones[z].name == name) return z;
+
+		Zone& zone = m_zones.emplace_back();
+		zone.name = name;
+		zone.depth = m_depth;
+		zone.history.fill(-1.0f);
+		return static_cast<uint32_t>(m_zones.size() - 1);
+	}
+
+	uint32_t GpuProfiler::BeginZone(const char* name)
+	{
+		Frame& frame = m_frames[m_frame_index];
+		const uint32_t zone = FindZone(name);
+		++m_depth;
+		if (frame.count == k_max_zones) return k_max_zones;
+
+		const uint32_t handle = frame.count++;
+		frame.zones[handle] = zone;
+		glQueryCounter(frame.queries[handle * 2], GL_TIMESTAMP);
+		return handle;
+	}
+
+	void GpuProfiler::EndZone(const uint32_t handle)
+	{
+		--m_depth;
+		if (handle == k_max_zones) return;
+		glQueryCounter(m_frames[m_frame_index].queries[handle * 2 + 1], GL_TIMESTAMP);
+	}
+
+	void GpuProfiler::Resolve(Frame& frame)
+	{
+		// Zones nest, so the zone begun last isn't the one ended last; check every end timestamp
+		// (each one is issued after its begin) so the GL_QUERY_RESULT reads below never block
+		for (uint32_t i = 0; i < frame.count; ++i)
+		{
+			GLint available = 0;
+			glGetQueryObjectiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+			{
+				++m_dropped_frames;
+				return;
+			}
+		}
+
+		const auto slot = static_cast<size_t>(m_resolved_frames % k_history);
+		++m_resolved_frames;
+		for (Zone& zone : m_zones) zone.history[slot] = -1.0f;
+
+		for (uint32_t i = 0; i < frame.count; ++i)
+		{
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+			float& sample = m_zones[frame.zones[i]].history[slot];
+			sample = std::max(sample, 0.0f) + static_cast<float>(end - begin) * 1e-6f;
+		}
+
+		for (Zone& zone : m_zones)
+		{
+			if (zone.history[slot] >= 0.0f) zone.last_ms = zone.history[slot];
+
+			float sum = 0.0f;
+			uint32_t samples = 0;
+			zone.max_ms = 0.0f;
+			for (const float ms : zone.history)
+			{
+				if (ms < 0.0f) continue;
+				sum += ms;
+				++samples;
+				zone.max_ms = std::max(zone.max_ms, ms);
+			}
+			zone.average_ms = samples > 0 ? sum / static_cast<float>(samples) : 0.0f;
+		}
+	}
+
+	float GpuProfiler::GetLastMilliseconds(const char* name) const
+	{
+		for (const Zone& zone : m_zones)
+			if (zone.name == name) return zone.last_ms;
+		return 0.0f;
+	}
+
+	bool GpuProfiler::WriteCsv(const std::string& path) const
+	{
+		std::ofstream out(path, std::ofstream::out | std::ofstream::trunc);
+		if (!out) return false;
+
+		out << "frame";
+		for (const Zone& zone : m_zones) out << ',' << zone.name << " (ms)";
+		out << '\n';
+
+		// Oldest frame first; empty cells where a zone didn't run
+		const uint64_t count = std::min<uint64_t>(m_resolved_frames, k_history);
+		for (uint64_t f = m_resolved_frames - count; f < m_resolved_frames; ++f)
+		{
+			out << f;
+			for (const Zone& zone : m_zones)
+			{
+				out << ',';
+				if (const float ms = zone.history[f % k_history]; ms >= 0.0f) out << ms;
+			}
+			out << '\n';
+		}
+		return static_cast<bool>(out);
+	}
+}
@@ -0,0 +1,181 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// Third-party
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// Hex
+#include "Renderer/LightGrid.h"
+
+namespace Hex
+{
+	void LightGrid::SetProjection(const float fov_y_degrees, const float aspect_ratio, const float near_plane,
+								  const float far_plane, const float grid_far)
+	{
+		const glm::vec4 key{ fov_y_degrees, aspect_ratio, near_plane, far_plane };
+		if (key == m_projection_key && grid_far == m_grid_far && !m_min_x.empty()) return;
+		m_projection_key = key;
+		m_grid_far = grid_far;
+
+		const float slice_far = std::clamp(grid_far, near_plane * 2.0f, far_plane);
+		const float log_ratio = std::log(slice_far / near_plane);
+		m_slice_scale = static_cast<float>(k_slices) / log_ratio;
+		m_slice_bias = -static_cast<float>(k_slices) * std::log(near_plane) / log_ratio;
+
+		m_slice_depths.resize(k_slices + 1);
+		for (uint32_t z = 0; z <= k_slices; ++z)
+			m_slice_depths[z] = near_plane * std::pow(slice_far / near_plane, static_cast<float>(z) / k_slices);
+		m_slice_depths[k_slices] = far_plane;
+
+		const float tan_y = std::tan(glm::radians(fov_y_degrees) * 0.5f);
+		m_tan_half_fov = { tan_y * aspect_ratio, tan_y };
+
+		m_min_x.resize(k_cluster_count); m_min_y.resize(k_cluster_count); m_min_z.resize(k_cluster_count);
+		m_max_x.resize(k_cluster_count); m_max_y.resize(k_cluster_count); m_max_z.resize(k_cluster_count);
+
+		// A tile's side planes go through the eye, so its box over a slice spans both the slice's near and far cross-sections
+		for (uint32_t z = 0; z < k_slices; ++z)
+		{
+			const float depth_near = m_slice_depths[z];
+			const float depth_far = m_slice_depths[z + 1];
+			for (uint32_t y = 0; y < k_tiles_y; ++y)
+			{
+				const float ndc_y0 = -1.0f + 2.0f * static_cast<float>(y) / k_tiles_y;
+				const float ndc_y1 = -1.0f + 2.0f * static_cast<float>(y + 1) / k_tiles_y;
+				for (uint32_t x = 0; x < k_tiles_x; ++x)
+				{
+					const float ndc_x0 = -1.0f + 2.0f * static_cast<float>(x) / k_tiles_x;
+					const float ndc_x1 = -1.0f + 2.0f * static_cast<float>(x + 1) / k_tiles_x;
+					const uint32_t c = x + (y + z * k_tiles_y) * k_tiles_x;
+
+					m_min_x[c] = std::min(ndc_x0 * depth_near, ndc_x0 * depth_far) * m_tan_half_fov.x;
+					m_max_x[c] = std::max(ndc_x1 * depth_near, ndc_x1 * depth_far) * m_tan_half_fov.x;
+					m_min_y[c] = std::min(ndc_y0 * depth_near, ndc_y0 * depth_far) * m_tan_half_fov.y;
+					m_max_y[c] = std::max(ndc_y1 * depth_near, ndc_y1 * depth_far) * m_tan_half_fov.y;
+					m_min_z[c] = depth_near;
+					m_max_z[c] = depth_far;
+				}
+			}
+		}
+	}
+
+	void LightGrid::TestRow(const uint32_t first, const uint32_t count, const glm::vec3& center, const float radius, const uint32_t light)
+	{
+		// Sphere against box: squared distance from the centre to the box, per axis max(min - c, c - max, 0)^2
+		uint32_t i = first;
+		const uint32_t end = first + count;
+
+#if defined(__SSE2__) || defined(_M_X64)
+		const __m128 cx = _mm_set1_ps(center.x);
+		const __m128 cy = _mm_set1_ps(center.y);
+		const __m128 cz = _mm_set1_ps(center.z);
+		const __m128 r2 = _mm_set1_ps(radius * radius);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (; i + 4 <= end; i += 4)
+		{
+			const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_x[i]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&m_max_x[i]))), zero);
+			const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_y[i]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&m_max_y[i]))), zero);
+			const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_z[i]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&m_max_z[i]))), zero);
+			const __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distance2, r2)));
+			while (mask)
+			{
+				m_pairs.emplace_back(i + static_cast<uint32_t>(std::countr_zero(mask)), light);
+				mask &= mask - 1;
+			}
+		}
+#endif
+
+		// Scalar tail, and the whole row on targets without SSE
+		for (; i < end; ++i)
+		{
+			const float dx = std::max({ m_min_x[i] - center.x, center.x - m_max_x[i], 0.0f });
+			const float dy = std::max({ m_min_y[i] - center.y, center.y - m_max_y[i], 0.0f });
+			const float dz = std::max({ m_min_z[i] - center.z, center.z - m_max_z[i], 0.0f });
+			if (dx * dx + dy * dy + dz * dz <= radius * radius) m_pairs.emplace_back(i, light);
+		}
+	}
+
+	void LightGrid::Assign(const std::vector<GpuLight>& lights, const glm::mat4& view)
+	{
+		m_pairs.clear();
+		const float near_plane = m_slice_depths.front();
+		const float far_plane = m_slice_depths.back();
+
+		for (uint32_t l = 0; l < lights.size(); ++l)
+		{
+			const GpuLight& light = lights[l];
+			glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+			center.z = -center.z; // depth in front of the camera
+			const float radius = light.range;
+			if (center.z + radius < near_plane || center.z - radius > far_plane) continue;
+
+			// Slices the sphere's depth range covers
+			const float depth_min = std::max(center.z - radius, near_plane);
+			const float depth_max = std::min(center.z + radius, far_plane);
+			const auto slice_of = [&](const float depth) {
+				const float s = std::floor(std::log(depth) * m_slice_scale + m_slice_bias);
+				return static_cast<uint32_t>(std::clamp(s, 0.0f, static_cast<float>(k_slices - 1)));
+			};
+			const uint32_t z0 = slice_of(depth_min);
+			const uint32_t z1 = slice_of(depth_max);
+
+			for (uint32_t z = z0; z <= z1; ++z)
+			{
+				// Tiles the sphere's box can project into within this slice. x / depth is monotonic in depth,
+				// so the extremes come from the corners of the box clipped to the slice.
+				const float d0 = std::max(m_slice_depths[z], depth_min);
+				const float d1 = std::min(m_slice_depths[z + 1], depth_max);
+				const auto tile_range = [&](const float c, const float tan_half, const uint32_t tiles, uint32_t& lo, uint32_t& hi) {
+					const float a = (c - radius) / tan_half, b = (c + radius) / tan_half;
+					const float ndc_lo = std::min(a / d0, a / d1);
+					const float ndc_hi = std::max(b / d0, b / d1);
+					const float t_lo = std::floor((ndc_lo * 0.5f + 0.5f) * static_cast<float>(tiles));
+					const float t_hi = std::floor((ndc_hi * 0.5f + 0.5f) * static_cast<float>(tiles));
+					if (t_hi < 0.0f || t_lo >= static_cast<float>(tiles)) return false;
+					lo = static_cast<uint32_t>(std::max(t_lo, 0.0f));
+					hi = static_cast<uint32_t>(std::min(t_hi, static_cast<float>(tiles - 1)));
+					return true;
+				};
+
+				uint32_t x0, x1, y0, y1;
+				if (!tile_range(center.x, m_tan_half_fov.x, k_tiles_x, x0, x1)) continue;
+				if (!tile_range(center.y, m_tan_half_fov.y, k_tiles_y, y0, y1)) continue;
+
+				for (uint32_t y = y0; y <= y1; ++y)
+					TestRow(x0 + (y + z * k_tiles_y) * k_tiles_x, x1 - x0 + 1, center, radius, l);
+			}
+		}
+
+		// Counting sort by cluster, so each cluster's lights are one contiguous run of the index list
+		m_clusters.assign(k_cluster_count, glm::uvec2(0u));
+		for (const glm::uvec2& pair : m_pairs) ++m_clusters[pair.x].y;
+
+		m_active_clusters = 0;
+		m_max_cluster_lights = 0;
+		uint32_t offset = 0;
+		for (glm::uvec2& cluster : m_clusters)
+		{
+			cluster.x = offset;
+			offset += cluster.y;
+			m_active_clusters += cluster.y > 0;
+			m_max_cluster_lights = std::max(m_max_cluster_lights, cluster.y);
+			cluster.y = 0;
+		}
+
+		m_light_indices.resize(m_pairs.size());
+		for (const glm::uvec2& pair : m_pairs)
+		{
+			glm::uvec2& cluster = m_clusters[pair.x];
+			m_light_indices[cluster.x + cluster.y++] = pair.y;
+		}
+	}
+}
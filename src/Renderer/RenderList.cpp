@@ -0,0 +1,341 @@
+#include "pch.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Hex
+#include "Renderer/RenderList.h"
+#include "Renderer/Data/Mesh.h"
+#include "Renderer/Data/Material.h"
+#include "Gameplay/EntityComponents.h"
+
+namespace Hex
+{
+	// Dirty transforms closer together than this are uploaded as one range
+	static constexpr uint32_t k_range_merge_gap = 8;
+
+	RenderList::RenderList(entt::registry& registry)
+		: m_registry(registry)
+	{
+		m_registry.on_construct<TransformComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_destroy<TransformComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_update<TransformComponent>().connect<&RenderList::OnTransformChanged>(*this);
+
+		m_registry.on_construct<MeshComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_update<MeshComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_destroy<MeshComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+
+		m_registry.on_construct<ModelComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_update<ModelComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_destroy<ModelComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+
+		m_registry.on_construct<MaterialComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_update<MaterialComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+		m_registry.on_destroy<MaterialComponent>().connect<&RenderList::OnDrawableChanged>(*this);
+
+		// Pick up anything that was created before we started listening
+		for (const auto entity : m_registry.view<TransformComponent>())
+			m_structure_dirty.push_back(entity);
+	}
+
+	RenderList::~RenderList()
+	{
+		m_registry.on_construct<TransformComponent>().disconnect(this);
+		m_registry.on_destroy<TransformComponent>().disconnect(this);
+		m_registry.on_update<TransformComponent>().disconnect(this);
+
+		m_registry.on_construct<MeshComponent>().disconnect(this);
+		m_registry.on_update<MeshComponent>().disconnect(this);
+		m_registry.on_destroy<MeshComponent>().disconnect(this);
+
+		m_registry.on_construct<ModelComponent>().disconnect(this);
+		m_registry.on_update<ModelComponent>().disconnect(this);
+		m_registry.on_destroy<ModelComponent>().disconnect(this);
+
+		m_registry.on_construct<MaterialComponent>().disconnect(this);
+		m_registry.on_update<MaterialComponent>().disconnect(this);
+		m_registry.on_destroy<MaterialComponent>().disconnect(this);
+	}
+
+	void RenderList::OnDrawableChanged(entt::registry&, const entt::entity entity)
+	{
+		m_structure_dirty.push_back(entity);
+	}
+
+	void RenderList::OnTransformChanged(entt::registry&, const entt::entity entity)
+	{
+		m_transform_dirty.push_back(entity);
+	}
+
+	void RenderList::Update()
+	{
+		HEX_PROFILE_SCOPE("RenderList::Update");
+		m_rebuilt = false;
+		m_first_moved_slot = static_cast<uint32_t>(m_proxies.size());
+		m_dirty_slots.clear();
+		m_dirty_ranges.clear();
+		m_resorted_count = 0;
+		m_updated_transform_count = 0;
+		m_moved_static_bounds.Resize(0);
+
+		if (!m_structure_dirty.empty())
+			ApplyStructuralChanges();
+
+		if (!m_transform_dirty.empty())
+			ApplyTransformChanges();
+	}
+
+	void RenderList::ApplyStructuralChanges()
+	{
+		HEX_PROFILE_SCOPE("RenderList::ApplyStructuralChanges");
+		std::sort(m_structure_dirty.begin(), m_structure_dirty.end());
+		m_structure_dirty.erase(std::unique(m_structure_dirty.begin(), m_structure_dirty.end()), m_structure_dirty.end());
+
+		const auto is_dirty = [this](const entt::entity entity) {
+			return std::binary_search(m_structure_dirty.begin(), m_structure_dirty.end(), entity);
+		};
+
+		// Drop every proxy owned by a changed entity; compacting in place keeps the survivors sorted
+		size_t kept = 0;
+		for (size_t i = 0; i < m_proxies.size(); ++i)
+		{
+			if (is_dirty(m_proxies[i].entity))
+			{
+				m_first_moved_slot = std::min(m_first_moved_slot, static_cast<uint32_t>(i));
+				continue;
+			}
+			m_proxies[kept] = m_proxies[i];
+			m_transforms[kept] = m_transforms[i];
+			m_sort_keys[kept] = m_sort_keys[i];
+			m_lods[kept] = m_lods[i];
+			m_dynamic[kept] = m_dynamic[i];
+			++kept;
+		}
+		m_proxies.resize(kept);
+		m_transforms.resize(kept);
+		m_sort_keys.resize(kept);
+		m_lods.resize(kept);
+		m_dynamic.resize(kept);
+
+		// Rebuild proxies for the changed entities that are still drawable
+		struct Pending { RenderProxy proxy; glm::mat4 model; };
+		std::vector<Pending> added;
+
+		for (const auto entity : m_structure_dirty)
+		{
+			if (!m_registry.valid(entity)) continue;
+
+			const auto* tc = m_registry.try_get<TransformComponent>(entity);
+			if (!tc) continue;
+
+			const auto* mat = m_registry.try_get<MaterialComponent>(entity);
+			Material* material = mat ? mat->material.get() : nullptr;
+			const glm::mat4 model = tc->GetMatrix();
+
+			if (const auto* mc = m_registry.try_get<MeshComponent>(entity); mc && mc->mesh)
+				added.push_back({ { entity, material, mc->mesh.get() }, model });
+
+			if (const auto* mdc = m_registry.try_get<ModelComponent>(entity); mdc && mdc->model)
+				for (const auto& submesh : mdc->model->GetMeshes())
+					added.push_back({ { entity, material, submesh.get() }, model });
+		}
+
+		// Only the new proxies are radix sorted by key, then merged into the already sorted list
+		{
+			HEX_PROFILE_SCOPE("RenderList sort");
+			m_sort_items.resize(added.size());
+			for (uint32_t i = 0; i < added.size(); ++i)
+				m_sort_items[i] = { MakeSortKey(added[i].proxy), i };
+			RadixSort(m_sort_items, m_sort_scratch);
+		}
+
+		const size_t total = m_proxies.size() + added.size();
+		std::vector<RenderProxy> proxies;
+		std::vector<glm::mat4> transforms;
+		std::vector<uint64_t> sort_keys;
+		std::vector<uint8_t> lods;
+		std::vector<uint8_t> dynamic;
+		proxies.reserve(total);
+		transforms.reserve(total);
+		sort_keys.reserve(total);
+		lods.reserve(total);
+		dynamic.reserve(total);
+
+		// Survivors go first among equal keys, so they keep their slots up to the first insertion
+		size_t i = 0, j = 0;
+		while (i < m_proxies.size() || j < added.size())
+		{
+			if (j == added.size() || (i < m_proxies.size() && m_sort_keys[i] <= m_sort_items[j].key))
+			{
+				proxies.push_back(m_proxies[i]);
+				transforms.push_back(m_transforms[i]);
+				sort_keys.push_back(m_sort_keys[i]);
+				lods.push_back(m_lods[i]);
+				dynamic.push_back(m_dynamic[i]);
+				++i;
+			}
+			else
+			{
+				m_first_moved_slot = std::min(m_first_moved_slot, static_cast<uint32_t>(proxies.size()));
+				const Pending& pending = added[m_sort_items[j].index];
+				proxies.push_back(pending.proxy);
+				transforms.push_back(pending.model);
+				sort_keys.push_back(m_sort_items[j].key);
+				lods.push_back(0);
+				dynamic.push_back(0);
+				++j;
+			}
+		}
+
+		m_proxies = std::move(proxies);
+		m_transforms = std::move(transforms);
+		m_sort_keys = std::move(sort_keys);
+		m_lods = std::move(lods);
+		m_dynamic = std::move(dynamic);
+
+		// Slots ahead of the first removal or insertion hold the same proxies as before
+		m_first_moved_slot = std::min(m_first_moved_slot, static_cast<uint32_t>(m_proxies.size()));
+		m_world_bounds.Resize(m_proxies.size());
+		for (size_t slot = m_first_moved_slot; slot < m_proxies.size(); ++slot)
+			m_world_bounds.Set(slot, m_proxies[slot].mesh->bounds.box, m_transforms[slot]);
+		m_resorted_count = static_cast<uint32_t>(added.size());
+
+		m_structure_dirty.clear();
+		RebuildLookups();
+
+		m_rebuilt = true;
+		++m_version;
+	}
+
+	void RenderList::ApplyTransformChanges()
+	{
+		HEX_PROFILE_SCOPE("RenderList::ApplyTransformChanges");
+		std::sort(m_transform_dirty.begin(), m_transform_dirty.end());
+		m_transform_dirty.erase(std::unique(m_transform_dirty.begin(), m_transform_dirty.end()), m_transform_dirty.end());
+
+		for (const auto entity : m_transform_dirty)
+		{
+			const auto it = m_entity_slots.find(entity);
+			if (it == m_entity_slots.end() || !m_registry.valid(entity)) continue;
+
+			const auto* tc = m_registry.try_get<TransformComponent>(entity);
+			if (!tc) continue;
+
+			// One matrix per entity, shared by all of its sub-mesh proxies
+			const glm::mat4 model = tc->GetMatrix();
+			for (const uint32_t slot : it->second)
+			{
+				// First move: the proxy leaves the static set, from where it was and into where it is now
+				if (!m_dynamic[slot])
+				{
+					m_dynamic[slot] = 1;
+					m_moved_static_bounds.Append(m_world_bounds, slot);
+					m_world_bounds.Set(slot, m_proxies[slot].mesh->bounds.box, model);
+					m_moved_static_bounds.Append(m_world_bounds, slot);
+				}
+
+				m_transforms[slot] = model;
+				m_world_bounds.Set(slot, m_proxies[slot].mesh->bounds.box, model);
+				m_dirty_slots.push_back(slot);
+			}
+			++m_updated_transform_count;
+		}
+		m_transform_dirty.clear();
+
+		// Slots from the first moved one on are uploaded whole after a rebuild; only earlier ones need ranges
+		std::erase_if(m_dirty_slots, [this](const uint32_t slot) { return slot >= m_first_moved_slot; });
+		if (m_dirty_slots.empty()) return;
+
+		std::sort(m_dirty_slots.begin(), m_dirty_slots.end());
+
+		InstanceRange range{ m_dirty_slots.front(), 1 };
+		for (size_t k = 1; k < m_dirty_slots.size(); ++k)
+		{
+			const uint32_t slot = m_dirty_slots[k];
+			if (slot < range.first + range.count + k_range_merge_gap)
+			{
+				range.count = std::max(range.count, slot - range.first + 1);
+			}
+			else
+			{
+				m_dirty_ranges.push_back(range);
+				range = { slot, 1 };
+			}
+		}
+		m_dirty_ranges.push_back(range);
+	}
+
+	InstanceRange RenderList::SelectLods(const LodSelection& selection)
+	{
+		m_lod_counts = {};
+		m_lod_changed_static_bounds.Resize(0);
+		uint32_t first_changed = static_cast<uint32_t>(m_lods.size());
+		uint32_t last_changed = 0;
+
+		for (const RenderBatch& batch : m_batches)
+		{
+			const uint32_t lod_count = selection.enabled ? batch.mesh->GetLodCount() : 1;
+			for (uint32_t slot = batch.first; slot < batch.first + batch.count; ++slot)
+			{
+				uint32_t lod = std::min<uint32_t>(m_lods[slot], lod_count - 1);
+				if (lod_count > 1)
+				{
+					// Sphere around the world box; from inside it the instance fills the screen
+					const float dx = m_world_bounds.center_x[slot] - selection.eye.x;
+					const float dy = m_world_bounds.center_y[slot] - selection.eye.y;
+					const float dz = m_world_bounds.center_z[slot] - selection.eye.z;
+					const float ex = m_world_bounds.extent_x[slot], ey = m_world_bounds.extent_y[slot], ez = m_world_bounds.extent_z[slot];
+					const float distance2 = dx * dx + dy * dy + dz * dz;
+					const float radius2 = ex * ex + ey * ey + ez * ez;
+					const float size = distance2 > radius2
+						? std::sqrt(radius2 / distance2) * selection.projection_scale
+						: std::numeric_limits<float>::max();
+
+					while (lod + 1 < lod_count && size < selection.screen_sizes[lod + 1] * (1.0f - selection.hysteresis)) ++lod;
+					while (lod > 0 && size > selection.screen_sizes[lod] * (1.0f + selection.hysteresis)) --lod;
+				}
+
+				++m_lod_counts[lod];
+				if (lod == m_lods[slot]) continue;
+
+				m_lods[slot] = static_cast<uint8_t>(lod);
+				if (!m_dynamic[slot]) m_lod_changed_static_bounds.Append(m_world_bounds, slot);
+				first_changed = std::min(first_changed, slot);
+				last_changed = std::max(last_changed, slot);
+			}
+		}
+
+		if (first_changed > last_changed) return {};
+		return { first_changed, last_changed - first_changed + 1 };
+	}
+
+	uint64_t RenderList::MakeSortKey(const RenderProxy& proxy)
+	{
+		// Casters without a material only show up in the shadow pass; they go after everything lit
+		const Material* material = proxy.material;
+		return DrawKey::Pack(proxy.mesh->GetGeometryLayout(),
+							 material ? DrawPass::Opaque : DrawPass::Shadow,
+							 m_shader_ids.Get(material ? material->shader.get() : nullptr),
+							 m_group_ids.Get(material ? material->GetBatchKey() : nullptr),
+							 m_material_ids.Get(material),
+							 m_mesh_ids.Get(proxy.mesh));
+	}
+
+	void RenderList::RebuildLookups()
+	{
+		m_entity_slots.clear();
+		m_batches.clear();
+
+		for (uint32_t slot = 0; slot < m_proxies.size(); ++slot)
+		{
+			const RenderProxy& proxy = m_proxies[slot];
+			m_entity_slots[proxy.entity].push_back(slot);
+
+			if (m_batches.empty() || m_batches.back().material != proxy.material || m_batches.back().mesh != proxy.mesh)
+				m_batches.push_back({ proxy.material, proxy.mesh, slot, 0 });
+			++m_batches.back().count;
+		}
+	}
+}
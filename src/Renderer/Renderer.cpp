@@ -1,7 +1,21 @@
 #include "pch.h"
 
+// STL
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+
 //Hex
 #include "Renderer/Renderer.h"
+#include "Renderer/Data/RingBuffer.h"
+#include "Renderer/Data/GeometryPool.h"
+#include "Renderer/Data/TextureAtlas.h"
+#include "Renderer/RenderList.h"
+#include "Renderer/Culling.h"
+#include "Renderer/GLState.h"
+#include "Renderer/GpuProfiler.h"
 
 namespace Hex
 {
@@ -21,11 +35,36 @@ namespace Hex
 
 	Renderer::~Renderer()
 	{
-
+		m_render_list.reset();
+		glDeleteBuffers(1, &m_instance_table.buffer);
+		glDeleteBuffers(1, &m_instance_bounds.buffer);
+		glDeleteBuffers(1, &m_instance_materials.buffer);
+		glDeleteBuffers(1, &m_instance_decode.buffer);
+		glDeleteBuffers(1, &m_instance_batches.buffer);
+		glDeleteBuffers(1, &m_instance_lods.buffer);
+		glDeleteBuffers(1, &m_gpu_command_template.buffer);
+		glDeleteBuffers(1, &m_gpu_commands.buffer);
+		glDeleteBuffers(1, &m_gpu_visible.buffer);
+		glDeleteBuffers(1, &m_cull_counters);
+		glDeleteBuffers(1, &m_light_buffer.buffer);
+		glDeleteBuffers(1, &m_light_cluster_buffer.buffer);
+		glDeleteBuffers(1, &m_light_index_buffer.buffer);
+		glDeleteFramebuffers(1, &m_shadow_map.static_fbo);
+		glDeleteTextures(1, &m_shadow_map.static_texture);
+		glDeleteFramebuffers(1, &m_point_shadows.fbo);
+		glDeleteFramebuffers(1, &m_point_shadows.static_fbo);
+		glDeleteTextures(1, &m_point_shadows.texture);
+		glDeleteTextures(1, &m_point_shadows.static_texture);
+		glDeleteTextures(1, &m_hiz.texture);
+		m_upload_ring.reset();
+		m_gpu_profiler.reset();
+		TextureAtlas::Shutdown();
+		GeometryPool::Shutdown();
 	}
 
 	void Renderer::Init(const AppSpecification& app_spec)
 	{
+		m_headless = app_spec.headless;
 		InitOpenGLContext(app_spec);
 		LogRendererInfo();
 
@@ -37,7 +76,29 @@ namespace Hex
 		glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_uboRenderData);
 		glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+		m_shadow_map.shadow_width = app_spec.shadow_map_size;
+		m_shadow_map.shadow_height = app_spec.shadow_map_size;
 		InitShadowMap();
+		InitPointShadowMaps();
+
+		// All per-frame uploads are staged through a persistently mapped ring
+		m_upload_ring = std::make_unique<RingBuffer>(k_upload_ring_size);
+
+		// Per-pass GPU time, for the profiler window and dynamic resolution
+		m_gpu_profiler = std::make_unique<GpuProfiler>();
+
+		// GPU culling writes its visible counts here; the CPU reads them back a few frames later
+		constexpr GLbitfield counter_flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		constexpr GLsizeiptr counter_bytes = RingBuffer::k_frames_in_flight * k_cull_counter_stride * sizeof(uint32_t);
+		glGenBuffers(1, &m_cull_counters);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_cull_counters);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, counter_bytes, nullptr, counter_flags);
+		m_cull_counters_mapped = static_cast<uint32_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, counter_bytes, counter_flags));
+		std::fill_n(m_cull_counters_mapped, RingBuffer::k_frames_in_flight * k_cull_counter_stride, 0u);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// Drawables are tracked incrementally instead of re-gathered every frame
+		m_render_list = std::make_unique<RenderList>(m_registry);
 
 		m_camera.reset(new Camera({-10.f, 10.f, 10.f}, -45.0f, -20.f));
 		InitFrameBuffer(app_spec.width, app_spec.height);
@@ -56,30 +117,56 @@ namespace Hex
 
 	void Renderer::Tick(const float& delta_time)
 	{
+		HEX_PROFILE_SCOPE("Renderer::Tick");
 		// Process input
-		m_camera->ProcessKeyboardInput(m_window.get(), delta_time);
+		if (!m_headless) m_camera->ProcessKeyboardInput(m_window.get(), delta_time);
 		m_camera->Tick(delta_time);
 
-		BindWindowBuffer();
-		StartImGuiFrame();
+		m_render_stats = {};
+		GLState::ResetStats();
+		m_gpu_profiler->BeginFrame();
+		const uint32_t frame_zone = m_gpu_profiler->BeginZone("Frame");
 
-		UpdateRenderData();
+		BindWindowBuffer();
+		if (!m_headless) StartImGuiFrame();
+
+		UpdateDynamicResolution();						// Render size for this frame, from the last GPU timings
+		UpdateShadowCascades();							// Cascade windows need to be known before culling
+		UpdateRenderData();								// Camera + cascade frustum planes go into the UBO
+		m_upload_ring->BeginFrame();					// Claim this frame's region of the upload ring
+		ExtractScene();									// Cull + upload instances once for every pass
+		UpdateLights();									// Point + spot lights into the cluster grid
+		UpdatePointShadows();							// Cube faces whose casters changed, and what to draw into them
 		if(!m_wireframe_mode) RenderShadowMap();		// First pass: Generate shadow map
+		if(!m_wireframe_mode) RenderPointShadows();		// Point light cube shadows, redrawn face by face
 
+		const uint32_t viewport_zone = m_gpu_profiler->BeginZone("Viewport");
 		BindFrameBuffer();								// Switch to primary frame buffer
 		if(!m_wireframe_mode) RenderFullScreenQuad();	// Second pass: Render sky background
+		if(UsesDepthPrepass()) RenderDepthPrepass();	// Optional: depth only, so shading runs once per pixel
 		//RenderScene();									// Third pass: Render scene with shadows
 		RenderSceneBatched();
+		BuildHiZBuffer();								// Depth pyramid the next frame's occlusion test reads
+		m_gpu_profiler->EndZone(viewport_zone);
+		m_upload_ring->EndFrame();					// Fence the region once every draw reading it is queued
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind frame buffer
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind frame buffer
 
-		// Render ImGui interface
-		ShowDebugUI(delta_time);
-		m_console->Render();
+		// Render ImGui interface; headless runs stop at the FrameBuffer
+		if (!m_headless)
+		{
+			ShowDebugUI(delta_time);
+			m_console->Render();
 
-		EndImGuiFrame(delta_time);
+			EndImGuiFrame(delta_time);
+			GLState::Invalidate();						// ImGui (and its viewport windows) bind behind the cache's back
+		}
+		m_gpu_profiler->EndZone(frame_zone);
 
-		glfwSwapBuffers(m_window.get());
+		{
+			HEX_PROFILE_SCOPE("glfwSwapBuffers");
+			glfwSwapBuffers(m_window.get());
+		}
 	}
 
 
@@ -102,7 +189,14 @@ namespace Hex
 		//TODO: Remove from release build?
 		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 
-		if(app_spec.fullscreen)
+		if(app_spec.headless)
+		{
+			// Never shown: the scene renders into the FrameBuffer and nothing reads the window's back buffer.
+			// Machines without a display can run this under a virtual X server (xvfb-run) with Mesa's llvmpipe.
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			m_window.reset(glfwCreateWindow(app_spec.width, app_spec.height, app_spec.name.c_str(), nullptr, nullptr));
+		}
+		else if(app_spec.fullscreen)
 		{
 			m_window.reset(glfwCreateWindow(app_spec.width, app_spec.height, app_spec.name.c_str(), glfwGetPrimaryMonitor(), nullptr));
 		}
@@ -134,7 +228,7 @@ namespace Hex
 			std::cout << "Failed to initialize GLAD" << std::endl;
 		}
 
-		glViewport(0, 0, app_spec.width, app_spec.height);
+		GLState::Viewport(0, 0, app_spec.width, app_spec.height);
 
 		glEnable(GL_DEBUG_OUTPUT);
 
@@ -144,7 +238,7 @@ namespace Hex
 			Log(LogLevel::Info, "OpenGL debug context enabled");
 		}
 
-		if(app_spec.vsync)
+		if(app_spec.vsync && !app_spec.headless)
 		{
 			glfwSwapInterval(1); // Enable VSync
 		}
@@ -154,6 +248,8 @@ namespace Hex
 		}
 
 		Texture::InitDefaults();
+		GeometryPool::Init();
+		if (app_spec.texture_arrays) TextureAtlas::Init();   // before any texture is loaded
 
 	}
 
@@ -242,32 +338,101 @@ namespace Hex
 		// Generate and configure the shadow map framebuffer
 		glGenFramebuffers(1, &m_shadow_map.fbo);
 
-		// Create the depth texture
+		// Create the depth texture array, one layer per cascade
 		glGenTextures(1, &m_shadow_map.texture);
-		glBindTexture(GL_TEXTURE_2D, m_shadow_map.texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F,
-			m_shadow_map.shadow_width, m_shadow_map.shadow_height, 0, GL_DEPTH_COMPONENT,
-			GL_FLOAT, nullptr);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_shadow_map.texture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F,
+			m_shadow_map.shadow_width, m_shadow_map.shadow_height, k_max_shadow_cascades);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		// enable GLSL sampler2DShadow-style comparisons
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// enable GLSL sampler2DArrayShadow-style comparisons
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
 		constexpr float border_color[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border_color);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border_color);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		// Plain 2D views of each layer so ImGui can display them
+		glGenTextures(k_max_shadow_cascades, m_shadow_map.layer_views.data());
+		for (int layer = 0; layer < k_max_shadow_cascades; ++layer)
+		{
+			const GLuint view = m_shadow_map.layer_views[layer];
+			glTextureView(view, GL_TEXTURE_2D, m_shadow_map.texture, GL_DEPTH_COMPONENT32F, 0, 1, layer, 1);
+			GLState::BindTexture(GL_TEXTURE_2D, view);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+		}
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.fbo);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_shadow_map.texture, 0);
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.fbo);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadow_map.texture, 0, 0);
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 			Log(LogLevel::Error, "Shadow map framebuffer is incomplete!");
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		// Static caster depth for shadow caching; never sampled, only copied into `texture`
+		glGenTextures(1, &m_shadow_map.static_texture);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_shadow_map.static_texture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F,
+			m_shadow_map.shadow_width, m_shadow_map.shadow_height, k_max_shadow_cascades);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		glGenFramebuffers(1, &m_shadow_map.static_fbo);
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.static_fbo);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadow_map.static_texture, 0, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			Log(LogLevel::Error, "Static shadow map framebuffer is incomplete!");
+
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void Renderer::InitPointShadowMaps()
+	{
+		// Two cube map arrays with one cube per slot: static casters only, and what debug.frag samples
+		constexpr float far_depth = 1.0f;
+		const GLsizei layers = static_cast<GLsizei>(6 * k_max_point_shadows);
+		for (GLuint* texture : { &m_point_shadows.texture, &m_point_shadows.static_texture })
+		{
+			glGenTextures(1, texture);
+			GLState::BindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, *texture);
+			glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 1, GL_DEPTH_COMPONENT32F, m_point_shadows.size, m_point_shadows.size, layers);
+
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+			glClearTexImage(*texture, 0, GL_DEPTH_COMPONENT, GL_FLOAT, &far_depth);
+		}
+		GLState::BindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+
+		// PCF taps near a face edge read across into the neighbouring face
+		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+		// Layered attachments: the geometry shader picks the face with gl_Layer
+		const std::pair<GLuint*, GLuint> targets[] = {
+			{ &m_point_shadows.fbo, m_point_shadows.texture },
+			{ &m_point_shadows.static_fbo, m_point_shadows.static_texture },
+		};
+		for (const auto& [fbo, texture] : targets)
+		{
+			glGenFramebuffers(1, fbo);
+			GLState::BindFramebuffer(GL_FRAMEBUFFER, *fbo);
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0);
+			glDrawBuffer(GL_NONE);
+			glReadBuffer(GL_NONE);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				Log(LogLevel::Error, "Point shadow framebuffer is incomplete!");
+		}
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
 	void Renderer::InitFrameBuffer(const int& width, const int& height)
@@ -278,17 +443,26 @@ namespace Hex
 		}
 
 		// Cleanup existing framebuffer
-		if (m_frame_buffer.frame_buffer) glDeleteFramebuffers(1, &m_frame_buffer.frame_buffer);
-		if (m_frame_buffer.texture) glDeleteTextures(1, &m_frame_buffer.texture);
-		if (m_frame_buffer.depth_render_buffer) glDeleteRenderbuffers(1, &m_frame_buffer.depth_render_buffer);
+		if (m_frame_buffer.frame_buffer) {
+			GLState::ForgetFramebuffer(m_frame_buffer.frame_buffer);
+			glDeleteFramebuffers(1, &m_frame_buffer.frame_buffer);
+		}
+		if (m_frame_buffer.texture) {
+			GLState::ForgetTexture(m_frame_buffer.texture);
+			glDeleteTextures(1, &m_frame_buffer.texture);
+		}
+		if (m_frame_buffer.depth_texture) {
+			GLState::ForgetTexture(m_frame_buffer.depth_texture);
+			glDeleteTextures(1, &m_frame_buffer.depth_texture);
+		}
 
 		// Create framebuffer
 		glGenFramebuffers(1, &m_frame_buffer.frame_buffer);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_frame_buffer.frame_buffer);
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, m_frame_buffer.frame_buffer);
 
 		// Create and attach color texture
 		glGenTextures(1, &m_frame_buffer.texture);
-		glBindTexture(GL_TEXTURE_2D, m_frame_buffer.texture);
+		GLState::BindTexture(GL_TEXTURE_2D, m_frame_buffer.texture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -299,11 +473,13 @@ namespace Hex
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_frame_buffer.texture, 0);
 
-		// Create and attach depth-stencil renderbuffer
-		glGenRenderbuffers(1, &m_frame_buffer.depth_render_buffer);
-		glBindRenderbuffer(GL_RENDERBUFFER, m_frame_buffer.depth_render_buffer);
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_frame_buffer.depth_render_buffer);
+		// Create and attach depth-stencil texture; a texture rather than a renderbuffer so the Hi-Z pass can read it
+		glGenTextures(1, &m_frame_buffer.depth_texture);
+		GLState::BindTexture(GL_TEXTURE_2D, m_frame_buffer.depth_texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_frame_buffer.depth_texture, 0);
 
 		// Check framebuffer completeness
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
@@ -312,58 +488,213 @@ namespace Hex
 			Log(LogLevel::Info, "Framebuffer initialized successfully.");
 		}
 
-		m_camera->SetAspectRatio(static_cast<float>(m_frame_buffer.render_width)/static_cast<float>(m_frame_buffer.render_height));
+		m_frame_buffer.width = static_cast<unsigned int>(width);
+		m_frame_buffer.height = static_cast<unsigned int>(height);
+		m_camera->SetAspectRatio(static_cast<float>(width)/static_cast<float>(height));
+
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind framebuffer
+
+		InitHiZBuffer(width, height);
+	}
+
+	void Renderer::InitHiZBuffer(const int width, const int height)
+	{
+		if (m_hiz.texture) {
+			GLState::ForgetTexture(m_hiz.texture);
+			glDeleteTextures(1, &m_hiz.texture);
+		}
+
+		// Full mip chain down to 1x1; level 0 matches the depth buffer texel for texel
+		m_hiz.width = width;
+		m_hiz.height = height;
+		m_hiz.levels = static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height))))) + 1;
+		m_hiz.valid = false;
+
+		glGenTextures(1, &m_hiz.texture);
+		GLState::BindTexture(GL_TEXTURE_2D, m_hiz.texture);
+		glTexStorage2D(GL_TEXTURE_2D, m_hiz.levels, GL_R32F, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void Renderer::BuildHiZBuffer()
+	{
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Hi-Z");
+
+		// Only the compute culling path reads the pyramid
+		if (!m_occlusion_culling || !m_gpu_culling || !m_hiz.texture) {
+			m_hiz.valid = false;
+			return;
+		}
+
+		auto hiz_shader = ShaderManager::GetOrCreateComputeShader(RESOURCES_PATH "shaders/hiz.comp");
+		hiz_shader->Bind();
+		hiz_shader->SetUniform1i("source", static_cast<int>(k_hiz_texture_unit));
+
+		const auto dispatch = [](const int width, const int height) {
+			glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+		};
+
+		// Level 0: copy of this frame's depth
+		GLState::BindTexture(k_hiz_texture_unit, GL_TEXTURE_2D, m_frame_buffer.depth_texture);
+		hiz_shader->SetUniform1i("source_level", 0);
+		hiz_shader->SetUniform1i("downsample", 0);
+		glBindImageTexture(0, m_hiz.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		dispatch(m_hiz.width, m_hiz.height);
+
+		// Every further level keeps the furthest depth of the 2x2 block above it
+		GLState::BindTexture(k_hiz_texture_unit, GL_TEXTURE_2D, m_hiz.texture);
+		hiz_shader->SetUniform1i("downsample", 1);
+		for (int level = 1; level < m_hiz.levels; ++level) {
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+			hiz_shader->SetUniform1i("source_level", level - 1);
+			glBindImageTexture(0, m_hiz.texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+			dispatch(std::max(m_hiz.width >> level, 1), std::max(m_hiz.height >> level, 1));
+		}
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		Shader::Unbind();
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind framebuffer
+		// Next frame tests its bounds against this frame's camera and render size
+		m_hiz.view_projection = m_render_data.projection * m_render_data.view;
+		m_hiz.view_width = static_cast<int>(m_frame_buffer.render_width);
+		m_hiz.view_height = static_cast<int>(m_frame_buffer.render_height);
+		m_hiz.valid = true;
 	}
 
 	void Renderer::BindFrameBuffer() const
 	{
 		// Bind framebuffer for rendering
-		glBindFramebuffer(GL_FRAMEBUFFER, m_frame_buffer.frame_buffer);
-		glViewport(0, 0, m_frame_buffer.render_width, m_frame_buffer.render_height); // Match viewport size to framebuffer
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, m_frame_buffer.frame_buffer);
+		GLState::Viewport(0, 0, m_frame_buffer.render_width, m_frame_buffer.render_height); // Match viewport size to framebuffer
 		glClearColor(0.f, 0.f, 0.f, 1.0f); // Sky blue color
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glEnable(GL_DEPTH_TEST);
+		GLState::SetEnabled(GL_DEPTH_TEST, true);
 	}
 
 	void Renderer::BindWindowBuffer() const
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind framebuffer
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0); // Unbind framebuffer
 		int width{0}, height{0};
 		glfwGetFramebufferSize(m_window.get(), &width, &height);
-		glViewport(0, 0, width, height); // Match viewport size to framebuffer
+		GLState::Viewport(0, 0, width, height); // Match viewport size to framebuffer
 		glClearColor(0.08f, 0.10f, 0.12f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
-	void Renderer::RenderShadowMap()
+	void Renderer::UpdateShadowCascades()
 	{
-	    glBindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.fbo);
-	    glViewport(0, 0, m_shadow_map.shadow_width, m_shadow_map.shadow_height);
-	    glClear(GL_DEPTH_BUFFER_BIT);
+		if (!m_cascaded_shadows)
+		{
+			// Compute the “scene box” we want to shadow:
+			const float R = 10.0f;  // adjust to cover your scene
+			glm::vec3 center = glm::vec3(0.0f);
 
-	    glEnable(GL_DEPTH_TEST);
-	    glEnable(GL_POLYGON_OFFSET_FILL);
-	    glPolygonOffset(2.0f, 4.0f);
-	    glCullFace(GL_FRONT);
-	    glEnable(GL_CULL_FACE);
-	    glDrawBuffer(GL_NONE);
 
-		// Compute the “scene box” we want to shadow:
-		const float R = 10.0f;  // adjust to cover your scene
-		glm::vec3 center = glm::vec3(0.0f);
+			// Get your light’s direction (unit vector).
+			glm::vec3 dir = glm::normalize(m_light_dir);
+
+			// Place the shadow‐camera “behind” the box along -dir at distance R.
+			glm::vec3 shadowCamPos = center - dir * R;
+
+			// Build view/proj
+			m_shadow_map.light_view[0]       = glm::lookAt(shadowCamPos, center, {0,1,0});
+			m_shadow_map.light_projection[0] = glm::ortho(-R, R, R, -R, 0.1f, 2.0f*R);
+			m_shadow_map.split_depths[0]     = m_camera->GetFarPlane();
+			m_shadow_map.cascade_count       = 1;
+			m_shadow_map.caster_frustums[0]  = Frustum::FromMatrix(m_shadow_map.light_projection[0] * m_shadow_map.light_view[0]);
+			return;
+		}
+
+		const int count = glm::clamp(m_cascade_count, 1, k_max_shadow_cascades);
+		const float near_plane = m_camera->GetNearPlane();
+		const float far_plane  = glm::min(m_shadow_distance, m_camera->GetFarPlane());
 
+		// Practical split scheme: blend of logarithmic and uniform splits
+		for (int i = 0; i < count; ++i)
+		{
+			const float p = static_cast<float>(i + 1) / static_cast<float>(count);
+			const float log_split = near_plane * std::pow(far_plane / near_plane, p);
+			const float uniform_split = near_plane + (far_plane - near_plane) * p;
+			m_shadow_map.split_depths[i] = glm::mix(uniform_split, log_split, m_cascade_split_lambda);
+		}
+		m_shadow_map.cascade_count = count;
 
-		// Get your light’s direction (unit vector).
-		glm::vec3 dir = glm::normalize(m_light_dir);
+		// One light orientation for every cascade; only the ortho window moves
+		const glm::vec3 dir = glm::normalize(m_light_dir);
+		const glm::vec3 up = std::abs(dir.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+		const glm::mat4 light_view = glm::lookAt(glm::vec3(0.0f), dir, up);
 
-		// Place the shadow‐camera “behind” the box along -dir at distance R.
-		glm::vec3 shadowCamPos = center - dir * R;
+		const glm::mat4 inv_view = glm::inverse(m_camera->GetViewMatrix());
+		const float tan_y = std::tan(glm::radians(m_camera->GetFieldOfView()) * 0.5f);
+		const float tan_x = tan_y * m_camera->GetAspectRatio();
 
-		// Build view/proj
-		m_shadow_map.light_view       = glm::lookAt(shadowCamPos, center, {0,1,0});
-		m_shadow_map.light_projection = glm::ortho(-R, R, R, -R, 0.1f, 2.0f*R);
+		float slice_near = near_plane;
+		for (int c = 0; c < count; ++c)
+		{
+			const float slice_far = m_shadow_map.split_depths[c];
+
+			// Corners of this slice of the camera frustum, in world space
+			std::array<glm::vec3, 8> corners;
+			int k = 0;
+			for (const float d : { slice_near, slice_far })
+				for (const float sx : { -1.0f, 1.0f })
+					for (const float sy : { -1.0f, 1.0f })
+						corners[k++] = glm::vec3(inv_view * glm::vec4(sx * tan_x * d, sy * tan_y * d, -d, 1.0f));
+
+			// A bounding sphere keeps the ortho window the same size however the camera turns
+			glm::vec3 center(0.0f);
+			for (const auto& corner : corners) center += corner;
+			center /= static_cast<float>(corners.size());
+
+			float radius = 0.0f;
+			for (const auto& corner : corners) radius = glm::max(radius, glm::length(corner - center));
+			radius = std::ceil(radius * 16.0f) / 16.0f;
+
+			// Snap the window to whole shadow texels so edges don't shimmer as the camera moves
+			const float texel = 2.0f * radius / static_cast<float>(m_shadow_map.shadow_width);
+			glm::vec3 center_ls = glm::vec3(light_view * glm::vec4(center, 1.0f));
+			center_ls.x = std::floor(center_ls.x / texel) * texel;
+			center_ls.y = std::floor(center_ls.y / texel) * texel;
+
+			// y flipped like the original single map. Casters in front of the near plane are
+			// pancaked onto it by GL_DEPTH_CLAMP during the shadow pass.
+			m_shadow_map.light_view[c] = light_view;
+			m_shadow_map.light_projection[c] = glm::ortho(
+				center_ls.x - radius, center_ls.x + radius,
+				center_ls.y + radius, center_ls.y - radius,
+				-center_ls.z - radius, -center_ls.z + radius);
+
+			// The near plane is dropped for caster culling: anything between the light and the
+			// slice can still throw a shadow into it
+			m_shadow_map.caster_frustums[c] = Frustum::FromMatrix(m_shadow_map.light_projection[c] * light_view);
+			m_shadow_map.caster_frustums[c].planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+			slice_near = slice_far;
+		}
+	}
+
+	void Renderer::RenderShadowMap()
+	{
+	    HEX_PROFILE_SCOPE("Renderer::RenderShadowMap");
+	    const auto start = std::chrono::steady_clock::now();
+
+	    GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Shadow cascades");
+
+	    GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.fbo);
+	    GLState::Viewport(0, 0, m_shadow_map.shadow_width, m_shadow_map.shadow_height);
+
+	    GLState::SetEnabled(GL_DEPTH_TEST, true);
+	    GLState::SetEnabled(GL_DEPTH_CLAMP, true);
+	    GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, true);
+	    glPolygonOffset(2.0f, 4.0f);
+	    GLState::CullFace(GL_FRONT);
+	    GLState::SetEnabled(GL_CULL_FACE, true);
+	    glDrawBuffer(GL_NONE);
 
 	    // bind shadow shader
 	    auto shadow_shader = ShaderManager::GetOrCreateShader(
@@ -371,86 +702,193 @@ namespace Hex
 	        RESOURCES_PATH "shaders/shadow.frag"
 	    );
 	    shadow_shader->Bind();
-	    shadow_shader->SetUniformMat4("light_view",       m_shadow_map.light_view);
-	    shadow_shader->SetUniformMat4("light_projection", m_shadow_map.light_projection);
-
-	    // --- gather all mesh+transform items ---
-	    struct Item { Mesh* mesh; glm::mat4 model; };
-	    std::vector<Item> items;
-
-	    // individual MeshComponents
-	    for (auto e : m_registry.view<TransformComponent, MeshComponent>()) {
-	        auto &tc = m_registry.get<TransformComponent>(e);
-	        auto &mc = m_registry.get<MeshComponent>(e);
-	        items.push_back({ mc.mesh.get(), tc.GetMatrix() });
-	    }
-	    // sub‐meshes in ModelComponents
-	    for (auto e : m_registry.view<TransformComponent, ModelComponent>()) {
-	        auto &tc  = m_registry.get<TransformComponent>(e);
-	        auto &mdc = m_registry.get<ModelComponent>(e);
-	        for (auto &sub : mdc.model->GetMeshes())
-	            items.push_back({ sub.get(), tc.GetMatrix() });
-	    }
-
-	    if (items.empty()) {
-	        glCullFace(GL_BACK);
-	        glDisable(GL_CULL_FACE);
-	        glDisable(GL_POLYGON_OFFSET_FILL);
-	        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	        return;
-	    }
-
-	    // --- sort and draw instanced per mesh ---
-	    std::sort(items.begin(), items.end(),
-	              [](auto const &a, auto const &b){ return a.mesh < b.mesh; });
-
-	    size_t idx = 0;
-	    while (idx < items.size()) {
-	        Mesh* mesh = items[idx].mesh;
-
-	        // collect all models for this mesh
-	        std::vector<glm::mat4> models;
-	        size_t j = idx;
-	        for (; j < items.size() && items[j].mesh == mesh; ++j)
-	            models.push_back(items[j].model);
-
-	        // upload per-instance buffer
-	        glBindBuffer(GL_ARRAY_BUFFER, mesh->instanceVBO);
-	        glBufferData(GL_ARRAY_BUFFER,
-	                     models.size() * sizeof(glm::mat4),
-	                     models.data(),
-	                     GL_DYNAMIC_DRAW);
-	        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	        // single instanced draw
-	        glBindVertexArray(mesh->VAO);
-	        glDrawElementsInstanced(
-	            GL_TRIANGLES,
-	            mesh->indexCount,
-	            GL_UNSIGNED_INT,
-	            nullptr,
-	            static_cast<GLsizei>(models.size())
-	        );
-	        glBindVertexArray(0);
-
-	        idx = j;
+	    BindSceneBuffers();
+
+	    const bool cached = m_shadow_caching && !m_gpu_culling;
+	    for (int cascade = 0; cascade < m_shadow_map.cascade_count; ++cascade) {
+	        const uint8_t bit = static_cast<uint8_t>(1u << cascade);
+	        if (cached && !(m_shadow_map.live_redraw & bit)) continue;
+
+	        shadow_shader->SetUniformMat4("light_view",       m_shadow_map.light_view[cascade]);
+	        shadow_shader->SetUniformMat4("light_projection", m_shadow_map.light_projection[cascade]);
+
+	        if (cached) {
+	            // Static casters into the cache when it went stale, then the cache into the sampled layer
+	            if (m_shadow_map.static_redraw & bit) {
+	                GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.static_fbo);
+	                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadow_map.static_texture, 0, cascade);
+	                glClear(GL_DEPTH_BUFFER_BIT);
+	                DrawShadowCasters(m_scene.shadow_static[cascade], m_scene.command_offset);
+	                m_shadow_map.static_valid |= bit;
+	            }
+	            glCopyImageSubData(m_shadow_map.static_texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, cascade,
+	                               m_shadow_map.texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, cascade,
+	                               m_shadow_map.shadow_width, m_shadow_map.shadow_height, 1);
+	            GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadow_map.fbo);
+	            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadow_map.texture, 0, cascade);
+	        } else {
+	            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadow_map.texture, 0, cascade);
+	            glClear(GL_DEPTH_BUFFER_BIT);
+	        }
+
+	        const PassDraws& casters = m_scene.shadow_cascades[cascade];
+	        if (casters.command_count == 0) continue;
+
+	        DrawShadowCasters(casters, m_scene.command_offset);
 	    }
+	    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	    GLState::BindVertexArray(0);
 
 	    Shader::Unbind();
-	    glCullFace(GL_BACK);
-	    glDisable(GL_CULL_FACE);
-	    glDisable(GL_POLYGON_OFFSET_FILL);
-	    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	    GLState::CullFace(GL_BACK);
+	    GLState::SetEnabled(GL_CULL_FACE, false);
+	    GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, false);
+	    GLState::SetEnabled(GL_DEPTH_CLAMP, false);
+	    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	    // restore viewport to window
 	    int w, h;
 	    glfwGetFramebufferSize(m_window.get(), &w, &h);
-	    glViewport(0, 0, w, h);
+	    GLState::Viewport(0, 0, w, h);
+
+	    m_render_stats.shadow_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Renderer::UpdateShadowCache()
+	{
+		m_shadow_map.static_redraw = 0;
+		m_shadow_map.live_redraw = 0;
+
+		// The GPU cull emits every caster per cascade with no static/dynamic split, so it always redraws in full
+		if (!m_shadow_caching || m_gpu_culling || m_wireframe_mode) {
+			m_shadow_map.static_valid = 0;
+			m_shadow_map.dynamic_cascades = 0;
+			return;
+		}
+
+		// Cached depth holds while its cascade's light matrix does and no static caster moved through it
+		// or switched LOD inside it; the fixed box keeps its matrix while the camera walks through LODs
+		const CullBounds& moved = m_render_list->GetMovedStaticBounds();
+		const CullBounds& relodded = m_render_list->GetLodChangedStaticBounds();
+		const auto cascade_mask = static_cast<uint8_t>((1u << m_shadow_map.cascade_count) - 1);
+		m_shadow_map.static_valid &= cascade_mask; // unused cascades aren't checked, so they start over when they return
+		for (int c = 0; c < m_shadow_map.cascade_count; ++c) {
+			const uint8_t bit = static_cast<uint8_t>(1u << c);
+			const glm::mat4 matrix = m_shadow_map.light_projection[c] * m_shadow_map.light_view[c];
+			if (matrix != m_shadow_map.static_matrices[c] || m_render_list->WasRebuilt()) {
+				m_shadow_map.static_matrices[c] = matrix;
+				m_shadow_map.static_valid &= static_cast<uint8_t>(~bit);
+				continue;
+			}
+			for (const CullBounds* stale : { &moved, &relodded })
+				for (uint32_t i = 0; i < stale->center_x.size(); ++i)
+					if (IsVisible(m_shadow_map.caster_frustums[c], *stale, i)) {
+						m_shadow_map.static_valid &= static_cast<uint8_t>(~bit);
+						break;
+					}
+		}
+		m_shadow_map.static_redraw = static_cast<uint8_t>(~m_shadow_map.static_valid & cascade_mask);
+	}
+
+	void Renderer::DrawShadowCasters(const PassDraws& casters, const GLintptr command_offset)
+	{
+		// depth only, so every caster of the pass goes out in a single multi-draw per geometry layout
+		uint32_t first_command = casters.first_command;
+		for (uint32_t layout = 0; layout < k_geometry_layout_count; ++layout) {
+			const uint32_t command_count = casters.layout_commands[layout];
+			if (command_count == 0) continue;
+
+			GeometryPool::Get()->Bind(layout);
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES,
+				GeometryPool::GetIndexGLType(layout),
+				reinterpret_cast<const void*>(command_offset + static_cast<GLintptr>(first_command) * sizeof(DrawElementsIndirectCommand)),
+				static_cast<GLsizei>(command_count),
+				0
+			);
+			first_command += command_count;
+			++m_render_stats.draw_calls;
+		}
+
+		m_render_stats.draw_commands += casters.command_count;
+		m_render_stats.instances += casters.instance_count;
+	}
+
+	void Renderer::RenderPointShadows()
+	{
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Point shadows");
+
+		const bool any_work = std::any_of(m_point_shadows.slots.begin(), m_point_shadows.slots.end(),
+										  [](const PointShadowSlot& slot) { return slot.live_redraw != 0; });
+		if (!any_work) return;
+
+		auto cube_shader = ShaderManager::GetOrCreateShader(
+			RESOURCES_PATH "shaders/shadow_cube.vert",
+			RESOURCES_PATH "shaders/shadow_cube.geom",
+			RESOURCES_PATH "shaders/shadow_cube.frag"
+		);
+		cube_shader->Bind();
+		BindSceneBuffers(m_point_shadow_draws, m_point_shadow_draws);
+
+		GLState::Viewport(0, 0, m_point_shadows.size, m_point_shadows.size);
+		GLState::SetEnabled(GL_DEPTH_TEST, true);
+		GLState::SetEnabled(GL_CULL_FACE, false); // both sides cast; the depth is a distance, so there is no acne from front faces to hide
+
+		static const std::array<std::string, 6> face_uniforms = {
+			"face_matrices[0]", "face_matrices[1]", "face_matrices[2]", "face_matrices[3]", "face_matrices[4]", "face_matrices[5]"
+		};
+		constexpr float far_depth = 1.0f;
+		const GLsizei size = m_point_shadows.size;
+
+		for (uint32_t s = 0; s < k_max_point_shadows; ++s) {
+			PointShadowSlot& slot = m_point_shadows.slots[s];
+			if (!slot.live_redraw) continue;
+
+			const GLint first_layer = static_cast<GLint>(s * 6);
+			cube_shader->SetUniformVec3("light_pos", slot.position);
+			cube_shader->SetUniform1f("far_plane", slot.range);
+			cube_shader->SetUniform1i("first_layer", first_layer);
+			for (int f = 0; f < 6; ++f)
+				cube_shader->SetUniformMat4(face_uniforms[f], slot.face_matrices[f]);
+
+			// Static casters: only the faces that lost their cached depth
+			if (slot.static_redraw) {
+				GLState::BindFramebuffer(GL_FRAMEBUFFER, m_point_shadows.static_fbo);
+				for (int f = 0; f < 6; ++f)
+					if (slot.static_redraw & (1u << f))
+						glClearTexSubImage(m_point_shadows.static_texture, 0, 0, 0, first_layer + f, size, size, 1,
+										   GL_DEPTH_COMPONENT, GL_FLOAT, &far_depth);
+
+				cube_shader->SetUniform1i("face_mask", slot.static_redraw);
+				DrawShadowCasters(slot.static_casters, m_point_shadow_command_offset);
+				slot.static_valid |= slot.static_redraw;
+			}
+
+			// Sampled faces start over from the static depth, then take the dynamic casters
+			for (int f = 0; f < 6; ++f)
+				if (slot.live_redraw & (1u << f))
+					glCopyImageSubData(m_point_shadows.static_texture, GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, first_layer + f,
+									   m_point_shadows.texture, GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, first_layer + f,
+									   size, size, 1);
+
+			if (slot.dynamic_casters.command_count > 0) {
+				GLState::BindFramebuffer(GL_FRAMEBUFFER, m_point_shadows.fbo);
+				cube_shader->SetUniform1i("face_mask", slot.live_redraw);
+				DrawShadowCasters(slot.dynamic_casters, m_point_shadow_command_offset);
+			}
+		}
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		GLState::BindVertexArray(0);
+		Shader::Unbind();
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
 	void Renderer::RenderFullScreenQuad() const
 	{
-		glDisable(GL_DEPTH_TEST);
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Sky");
+
+		GLState::SetEnabled(GL_DEPTH_TEST, false);
 
 		// Use the gradient shader
 		auto gradientShader = ShaderManager::GetOrCreateShader(
@@ -471,18 +909,18 @@ namespace Hex
 		gradientShader->SetUniformVec3("bottomColor", glm::vec3(0.87f,0.94f,1.0f));
 		gradientShader->SetUniform1f("mieG", 0.8f);
 
-		glBindVertexArray(m_screen_quad.get()->vao);
+		GLState::BindVertexArray(m_screen_quad.get()->vao);
 		glDrawArrays(GL_TRIANGLES, 0, 6); // Draw the quad as two triangles
-		glBindVertexArray(0);
+		GLState::BindVertexArray(0);
 
 		Shader::Unbind();
 
-		glEnable(GL_DEPTH_TEST);
+		GLState::SetEnabled(GL_DEPTH_TEST, true);
 	}
 
 	void Renderer::RenderScene() const
 	{
-		glm::mat4 lightSpace = m_shadow_map.light_projection * m_shadow_map.light_view;
+		glm::mat4 lightSpace = m_shadow_map.light_projection[0] * m_shadow_map.light_view[0];
 
 		for (auto e : m_registry.view<TransformComponent, MeshComponent>()) {
 			auto &tc = m_registry.get<TransformComponent>(e);
@@ -491,8 +929,7 @@ namespace Hex
 
 			mat.material->Apply();
 
-			glActiveTexture(GL_TEXTURE4);
-			glBindTexture(GL_TEXTURE_2D, m_shadow_map.texture);
+			GLState::BindTexture(4, GL_TEXTURE_2D_ARRAY, m_shadow_map.texture);
 			mat.material->shader->SetUniformMat4("model", tc.GetMatrix());
 			mat.material->shader->SetUniformMat4("light_space_matrix", lightSpace);
 			mat.material->shader->SetUniform1i("should_shade", 1);
@@ -508,8 +945,7 @@ namespace Hex
 
 			mat.material->Apply();
 
-			glActiveTexture(GL_TEXTURE4);
-			glBindTexture(GL_TEXTURE_2D, m_shadow_map.texture);
+			GLState::BindTexture(4, GL_TEXTURE_2D_ARRAY, m_shadow_map.texture);
 			mat.material->shader->SetUniformMat4("model", tc.GetMatrix());
 			mat.material->shader->SetUniformMat4("light_space_matrix", lightSpace);
 			mat.material->shader->SetUniform1i("should_shade", 1);
@@ -520,102 +956,650 @@ namespace Hex
 
 	}
 
-	void Renderer::RenderSceneBatched() const {
-		glm::mat4 lightSpace = m_shadow_map.light_projection * m_shadow_map.light_view;
+	void Renderer::RenderSceneBatched() {
+		HEX_PROFILE_SCOPE("Renderer::RenderSceneBatched");
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Scene");
+
+		if (m_scene.opaque.empty()) {
+			// nothing to draw
+			return;
+		}
 
-		struct Item { Material* mat; Mesh* mesh; glm::mat4 model; };
-		std::vector<Item> items;
+		// every mesh shares the pool's VAO; instances and commands were uploaded once by ExtractScene
+		BindSceneBuffers();
 
-		// Gather MeshComponents
-		{
-			auto view = m_registry.view<TransformComponent, MeshComponent, MaterialComponent>();
-			items.reserve(std::distance(view.begin(), view.end()));
-			for (auto e : view) {
-				auto& tc  = m_registry.get<TransformComponent>(e);
-				auto& mc  = m_registry.get<MeshComponent>(e);
-				auto& mat = m_registry.get<MaterialComponent>(e);
-				items.push_back({ mat.material.get(),
-								  mc.mesh.get(),
-								  tc.GetMatrix() });
-			}
+		// With depth already laid down only the front-most fragment of each pixel passes
+		if (UsesDepthPrepass()) {
+			GLState::DepthFunc(GL_EQUAL);
+			GLState::DepthMask(false);
 		}
 
-		// Gather ModelComponents (each model may have multiple sub-meshes)
-		{
-			auto view = m_registry.view<TransformComponent, ModelComponent, MaterialComponent>();
-			for (auto e : view) {
-				auto& tc   = m_registry.get<TransformComponent>(e);
-				auto& mdc  = m_registry.get<ModelComponent>(e);
-				auto& mat  = m_registry.get<MaterialComponent>(e);
-				for (auto& submesh : mdc.model->GetMeshes()) {
-					items.push_back({ mat.material.get(),
-									  submesh.get(),
-									  tc.GetMatrix() });
-				}
-			}
+		// Cascade matrices and splits come from RenderData; the shadow map sits on its fixed unit for every material
+		GLState::BindTexture(k_shadow_map_unit, GL_TEXTURE_2D_ARRAY, m_shadow_map.texture);
+		GLState::BindTexture(k_point_shadow_unit, GL_TEXTURE_CUBE_MAP_ARRAY, m_point_shadows.texture);
+
+		// Clustered lights: every material shades with the same grid
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_lights_binding, m_light_buffer.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_light_clusters_binding, m_light_cluster_buffer.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_light_indices_binding, m_light_index_buffer.buffer);
+
+		// Atlased materials find their layers through the instance's material record
+		if (TextureAtlas* atlas = TextureAtlas::Get()) {
+			atlas->BindMaterialRecords();
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_instance_materials_binding, m_instance_materials.buffer);
 		}
 
-		if (items.empty()) {
-			// nothing to draw
-			return;
+		for (const DrawBucket& bucket : m_scene.opaque) {
+			// parameter block + PBR maps, or the atlas pages every material of the bucket shares
+			bucket.material->Apply();
+			GeometryPool::Get()->Bind(bucket.layout);
+
+			// one multi-draw for the whole bucket
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES,
+				GeometryPool::GetIndexGLType(bucket.layout),
+				reinterpret_cast<const void*>(m_scene.command_offset + static_cast<GLintptr>(bucket.first_command) * sizeof(DrawElementsIndirectCommand)),
+				static_cast<GLsizei>(bucket.command_count),
+				0
+			);
+
+			++m_render_stats.draw_calls;
+			m_render_stats.draw_commands += bucket.command_count;
+			m_render_stats.instances += bucket.instance_count;
 		}
 
-		// Sort by material, then mesh
-		std::sort(items.begin(), items.end(), [](auto const &a, auto const &b) {
-			if (a.mat  != b.mat)  return a.mat  < b.mat;
-			return   a.mesh < b.mesh;
-		});
+		GLState::DepthFunc(GL_LESS);
+		GLState::DepthMask(true);
 
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		GLState::BindVertexArray(0);
+
+		Shader::Unbind();
+	}
+
+	void Renderer::RenderDepthPrepass()
+	{
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "Depth prepass");
 
-		size_t idx = 0;
-		while (idx < items.size()) {
-			auto mat  = items[idx].mat;
-			auto mesh = items[idx].mesh;
-
-			// collect per-instance matrices
-			std::vector<glm::mat4> models;
-			size_t j = idx;
-			for (; j < items.size() && items[j].mat == mat && items[j].mesh == mesh; ++j)
-				models.push_back(items[j].model);
-			GLsizei instanceCount = GLsizei(models.size());
-
-			// upload instance‐models
-			glBindBuffer(GL_ARRAY_BUFFER, mesh->instanceVBO);
-			glBufferData(GL_ARRAY_BUFFER,
-						 instanceCount * sizeof(glm::mat4),
-						 models.data(),
-						 GL_DYNAMIC_DRAW);
-
-			// set up material + PBR maps
-			mat->Apply();
-
-			// set per‐draw uniforms
-			auto s = mat->shader.get();
-			s->SetUniformMat4("light_space_matrix", lightSpace);
-			s->SetUniform1i("should_shade",        1);
-
-			// bind shadow map
-			glActiveTexture(GL_TEXTURE5);
-			glBindTexture(GL_TEXTURE_2D, m_shadow_map.texture);
-			s->SetUniform1i("shadow_map", 5);
-
-			// draw instanced
-			glBindVertexArray(mesh->VAO);
-			glDrawElementsInstanced(
+		if (m_scene.opaque.empty()) return;
+
+		auto depth_shader = ShaderManager::GetOrCreateShader(
+			RESOURCES_PATH "shaders/depth.vert",
+			RESOURCES_PATH "shaders/depth.frag"
+		);
+		depth_shader->Bind();
+
+		BindSceneBuffers();
+		GLState::ColorMask(false);
+
+		// Same commands as the colour pass, but no material switches: buckets that sit next to each
+		// other in the command buffer, in the same geometry layout, go out as one multi-draw
+		size_t i = 0;
+		while (i < m_scene.opaque.size()) {
+			const uint32_t first_command = m_scene.opaque[i].first_command;
+			const uint32_t layout = m_scene.opaque[i].layout;
+			uint32_t command_count = 0;
+			uint32_t instance_count = 0;
+			do {
+				command_count += m_scene.opaque[i].command_count;
+				instance_count += m_scene.opaque[i].instance_count;
+				++i;
+			} while (i < m_scene.opaque.size() && m_scene.opaque[i].first_command == first_command + command_count &&
+					 m_scene.opaque[i].layout == layout);
+
+			GeometryPool::Get()->Bind(layout);
+			glMultiDrawElementsIndirect(
 				GL_TRIANGLES,
-				mesh->indexCount,
-				GL_UNSIGNED_INT,
-				nullptr,
-				instanceCount
+				GeometryPool::GetIndexGLType(layout),
+				reinterpret_cast<const void*>(m_scene.command_offset + static_cast<GLintptr>(first_command) * sizeof(DrawElementsIndirectCommand)),
+				static_cast<GLsizei>(command_count),
+				0
 			);
-			glBindVertexArray(0);
 
-			idx = j;
+			++m_render_stats.draw_calls;
+			m_render_stats.draw_commands += command_count;
+			m_render_stats.instances += instance_count;
 		}
 
+		GLState::ColorMask(true);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		GLState::BindVertexArray(0);
+
 		Shader::Unbind();
 	}
 
+	void Renderer::ExtractScene()
+	{
+		HEX_PROFILE_SCOPE("Renderer::ExtractScene");
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t uploaded_before = m_upload_ring->GetStats().bytes_uploaded;
+
+		m_render_list->Update();
+		SelectLods();
+
+		m_render_stats.proxies_resorted = m_render_list->GetResortedCount();
+		m_render_stats.transforms_updated = m_render_list->GetUpdatedTransformCount();
+
+		UploadInstances();
+		m_scene.instance_count = m_instance_table.count;
+		m_scene.opaque.clear();
+		m_scene.shadow_cascades = {};
+		m_scene.shadow_static = {};
+		UpdateShadowCache();
+
+		if (m_gpu_culling)
+			CullOnGpu();
+		else
+			CullOnCpu();
+
+		m_render_stats.instance_bytes = m_upload_ring->GetStats().bytes_uploaded - uploaded_before;
+		m_render_stats.extract_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Renderer::SelectLods()
+	{
+		// A sphere covers radius / (distance * tan(fov_y / 2)) of the screen height
+		m_lod_selection.eye = m_camera->GetPosition();
+		m_lod_selection.projection_scale = 1.0f / std::tan(glm::radians(m_camera->GetFieldOfView()) * 0.5f);
+
+		m_lod_changes = m_render_list->SelectLods(m_lod_selection);
+		m_render_stats.lod_proxies = m_render_list->GetLodCounts();
+	}
+
+	void Renderer::UploadInstances()
+	{
+		HEX_PROFILE_SCOPE("Renderer::UploadInstances");
+		const auto& transforms = m_render_list->GetTransforms();
+		const auto instance_count = static_cast<uint32_t>(transforms.size());
+		// Slots ahead of this kept their proxy through the list update; everything from it on has moved
+		const uint32_t first_moved = m_render_list->GetFirstMovedSlot();
+
+		const auto stage_transforms = [&](const uint32_t first, const uint32_t count) {
+			if (count == 0) return;
+			StageUpload(m_instance_table.buffer,
+						static_cast<GLintptr>(first) * sizeof(glm::mat4),
+						&transforms[first],
+						static_cast<GLsizeiptr>(count) * sizeof(glm::mat4));
+		};
+
+		// Only changed ranges and the moved tail are uploaded, unless the table had to grow
+		if (EnsureCapacity(m_instance_table, instance_count, sizeof(glm::mat4))) {
+			stage_transforms(0, instance_count);
+		} else {
+			for (const InstanceRange& range : m_render_list->GetDirtyRanges())
+				stage_transforms(range.first, range.count);
+			stage_transforms(first_moved, instance_count - first_moved);
+		}
+		m_instance_table.count = instance_count;
+
+		// Vertex decode record per proxy, from its mesh; meshes only change along with the list order
+		const bool decode_grown = instance_count > 0 && EnsureCapacity(m_instance_decode, instance_count, sizeof(VertexDecode));
+		if (instance_count > 0 && (decode_grown || m_render_list->GetVersion() != m_instance_decode_version)) {
+			// Just the moved tail when the buffer kept its contents and missed only the last update
+			const uint32_t first = !decode_grown && m_render_list->GetVersion() == m_instance_decode_version + 1 ? first_moved : 0;
+			m_instance_decode_version = m_render_list->GetVersion();
+
+			std::vector<VertexDecode> records(instance_count - first);
+			const auto& proxies = m_render_list->GetProxies();
+			for (uint32_t i = first; i < instance_count; ++i)
+				records[i - first] = proxies[i].mesh->GetVertexDecode();
+
+			if (!records.empty())
+				StageUpload(m_instance_decode.buffer, static_cast<GLintptr>(first) * sizeof(VertexDecode), records.data(),
+							static_cast<GLsizeiptr>(records.size() * sizeof(VertexDecode)));
+			m_instance_decode.count = instance_count;
+		}
+
+		// Atlas material record per proxy; materials only change along with the list order
+		const bool materials_grown = TextureAtlas::Get() && instance_count > 0 && EnsureCapacity(m_instance_materials, instance_count, sizeof(uint32_t));
+		if (TextureAtlas::Get() && instance_count > 0 && (materials_grown || m_render_list->GetVersion() != m_instance_materials_version)) {
+			const uint32_t first = !materials_grown && m_render_list->GetVersion() == m_instance_materials_version + 1 ? first_moved : 0;
+			m_instance_materials_version = m_render_list->GetVersion();
+
+			std::vector<uint32_t> records(instance_count - first, 0u);
+			const auto& proxies = m_render_list->GetProxies();
+			for (uint32_t i = first; i < instance_count; ++i)
+				if (proxies[i].material && proxies[i].material->UsesAtlas()) records[i - first] = proxies[i].material->GetAtlasRecord();
+
+			if (!records.empty())
+				StageUpload(m_instance_materials.buffer, static_cast<GLintptr>(first) * sizeof(uint32_t), records.data(),
+							static_cast<GLsizeiptr>(records.size() * sizeof(uint32_t)));
+			m_instance_materials.count = instance_count;
+		}
+
+		// World bounds only need to live on the GPU while it is doing the culling
+		if (m_gpu_culling) {
+			const CullBounds& bounds = m_render_list->GetWorldBounds();
+			const auto stage_bounds = [&](const uint32_t first, const uint32_t count) {
+				if (count == 0) return;
+				m_bounds_scratch.resize(static_cast<size_t>(count) * 2);
+				for (uint32_t i = 0; i < count; ++i) {
+					const uint32_t slot = first + i;
+					m_bounds_scratch[i * 2]     = glm::vec4(bounds.center_x[slot], bounds.center_y[slot], bounds.center_z[slot], 0.0f);
+					m_bounds_scratch[i * 2 + 1] = glm::vec4(bounds.extent_x[slot], bounds.extent_y[slot], bounds.extent_z[slot], 0.0f);
+				}
+				StageUpload(m_instance_bounds.buffer,
+							static_cast<GLintptr>(first) * 2 * sizeof(glm::vec4),
+							m_bounds_scratch.data(),
+							static_cast<GLsizeiptr>(count) * 2 * sizeof(glm::vec4));
+			};
+
+			if (EnsureCapacity(m_instance_bounds, instance_count, 2 * sizeof(glm::vec4)) || !m_gpu_bounds_current) {
+				stage_bounds(0, instance_count);
+			} else {
+				for (const InstanceRange& range : m_render_list->GetDirtyRanges())
+					stage_bounds(range.first, range.count);
+				stage_bounds(first_moved, instance_count - first_moved);
+			}
+			m_instance_bounds.count = instance_count;
+
+			// One byte per proxy, which cull.comp reads four to a uint; only the slots whose LOD changed go up
+			const auto& lods = m_render_list->GetLods();
+			const auto stage_lods = [&](const uint32_t first, const uint32_t count) {
+				if (count == 0) return;
+				StageUpload(m_instance_lods.buffer, first, &lods[first], count);
+			};
+
+			if (EnsureCapacity(m_instance_lods, (instance_count + 3) / 4, sizeof(uint32_t)) || !m_gpu_bounds_current) {
+				stage_lods(0, instance_count);
+			} else {
+				stage_lods(m_lod_changes.first, m_lod_changes.count);
+				stage_lods(first_moved, instance_count - first_moved);
+			}
+			m_instance_lods.count = instance_count;
+		}
+		m_gpu_bounds_current = m_gpu_culling;
+	}
+
+	void Renderer::CullOnCpu()
+	{
+		HEX_PROFILE_SCOPE("Renderer::CullOnCpu");
+		const uint32_t instance_count = m_scene.instance_count;
+
+		// Cull each view against the shared world bounds
+		const CullBounds& bounds = m_render_list->GetWorldBounds();
+		m_camera_visible.clear();
+		FrustumCull(m_camera_frustum, bounds, 0, instance_count, m_camera_visible);
+		if (m_front_to_back) SortFrontToBack(m_camera_visible);
+
+		m_render_stats.visible = static_cast<uint32_t>(m_camera_visible.size());
+		m_render_stats.culled = instance_count - m_render_stats.visible;
+
+		// Build every view's instance indices and commands, then write them with a single ring allocation
+		m_view_indices.clear();
+		m_view_commands.clear();
+
+		// Casters are culled per cascade in light space
+		const int cascades = m_wireframe_mode ? 0 : m_shadow_map.cascade_count;
+		const bool cached = m_shadow_caching;
+		uint8_t dynamic_cascades = 0;
+		for (int c = 0; c < cascades; ++c) {
+			m_shadow_visible.clear();
+			FrustumCull(m_shadow_map.caster_frustums[c], bounds, 0, instance_count, m_shadow_visible);
+			m_render_stats.shadow_culled += instance_count - static_cast<uint32_t>(m_shadow_visible.size());
+
+			if (!cached) {
+				m_scene.shadow_cascades[c] = AppendViewDraws(m_shadow_visible, false);
+				m_render_stats.shadow_visible += static_cast<uint32_t>(m_shadow_visible.size());
+				continue;
+			}
+
+			// Static casters only when the cascade's cached depth is redrawn; dynamic ones every frame
+			const auto& dynamic = m_render_list->GetDynamic();
+			m_static_casters.clear();
+			m_dynamic_casters.clear();
+			for (const uint32_t slot : m_shadow_visible)
+				(dynamic[slot] ? m_dynamic_casters : m_static_casters).push_back(slot);
+
+			const uint8_t bit = static_cast<uint8_t>(1u << c);
+			if (m_shadow_map.static_redraw & bit) {
+				m_scene.shadow_static[c] = AppendViewDraws(m_static_casters, false);
+				m_render_stats.shadow_visible += static_cast<uint32_t>(m_static_casters.size());
+			}
+			if (!m_dynamic_casters.empty()) {
+				m_scene.shadow_cascades[c] = AppendViewDraws(m_dynamic_casters, false);
+				m_render_stats.shadow_visible += static_cast<uint32_t>(m_dynamic_casters.size());
+				dynamic_cascades |= bit;
+			}
+		}
+
+		// A layer is rebuilt when its static depth changed, or it has (or last frame had) dynamic casters on top
+		if (cached) {
+			m_shadow_map.live_redraw = static_cast<uint8_t>(m_shadow_map.static_redraw | dynamic_cascades | m_shadow_map.dynamic_cascades);
+			m_shadow_map.dynamic_cascades = dynamic_cascades;
+			for (int c = 0; c < cascades; ++c) {
+				m_render_stats.shadow_cascades_static += (m_shadow_map.static_redraw >> c) & 1u;
+				m_render_stats.shadow_cascades_cached += !((m_shadow_map.live_redraw >> c) & 1u);
+			}
+		}
+
+		AppendViewDraws(m_camera_visible, true);
+
+		if (UploadViewDraws(m_scene.index_buffer, m_scene.command_offset))
+			m_scene.command_buffer = m_scene.index_buffer;
+	}
+
+	bool Renderer::UploadViewDraws(GLuint& buffer, GLintptr& command_offset)
+	{
+		const GLsizeiptr index_bytes = static_cast<GLsizeiptr>(m_view_indices.size() * sizeof(uint32_t));
+		const GLsizeiptr command_bytes = static_cast<GLsizeiptr>(m_view_commands.size() * sizeof(DrawElementsIndirectCommand));
+		if (index_bytes == 0) return false;
+
+		auto upload = m_upload_ring->Allocate(index_bytes + command_bytes, sizeof(uint32_t));
+		std::memcpy(upload.data, m_view_indices.data(), static_cast<size_t>(index_bytes));
+
+		// base_instance was relative to the start of the index array; make it relative to the ring
+		const GLuint base_instance = static_cast<GLuint>(upload.offset / sizeof(uint32_t));
+		auto* commands = reinterpret_cast<DrawElementsIndirectCommand*>(static_cast<uint8_t*>(upload.data) + index_bytes);
+		for (size_t i = 0; i < m_view_commands.size(); ++i) {
+			commands[i] = m_view_commands[i];
+			commands[i].base_instance += base_instance;
+		}
+
+		buffer = upload.buffer;
+		command_offset = upload.offset + index_bytes;
+		return true;
+	}
+
+	void Renderer::CullOnGpu()
+	{
+		HEX_PROFILE_SCOPE("Renderer::CullOnGpu");
+		GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "GPU culling");
+
+		const uint32_t instance_count = m_scene.instance_count;
+		const auto& batches = m_render_list->GetBatches();
+		const auto batch_count = static_cast<uint32_t>(batches.size());
+		const uint32_t cascades = m_wireframe_mode ? 0 : static_cast<uint32_t>(m_shadow_map.cascade_count);
+		const uint32_t view_count = 1 + cascades;
+
+		// Counters written k_frames_in_flight frames ago; the ring has already waited for that frame
+		const uint32_t counter_offset = (m_cull_frame++ % RingBuffer::k_frames_in_flight) * k_cull_counter_stride;
+		const uint32_t* counts = m_cull_counters_mapped + counter_offset;
+		m_render_stats.visible = counts[0];
+		m_render_stats.occluded = counts[k_max_cull_views];
+		m_render_stats.culled = m_scene.instance_count - std::min(counts[0] + counts[k_max_cull_views], m_scene.instance_count);
+		for (uint32_t c = 0; c < cascades; ++c) {
+			m_render_stats.shadow_visible += counts[1 + c];
+			m_render_stats.shadow_culled += m_scene.instance_count - std::min(counts[1 + c], m_scene.instance_count);
+		}
+		m_render_stats.instances += m_render_stats.visible + m_render_stats.shadow_visible;
+
+		if (instance_count == 0 || batch_count == 0) return;
+
+		// Command templates (instance_count = 0) and per-proxy batch ids only change with the list order
+		if (m_render_list->GetVersion() != m_gpu_cull_version || view_count != m_gpu_cull_views) {
+			m_gpu_cull_version = m_render_list->GetVersion();
+			m_gpu_cull_views = view_count;
+
+			// A batch gets one command per LOD; the proxy's LOD picks which one it is appended to
+			std::vector<uint32_t> batch_commands(instance_count);
+			uint32_t view_commands = 0;
+			uint32_t view_slots = 0;
+			for (const RenderBatch& batch : batches) {
+				std::fill_n(batch_commands.begin() + batch.first, batch.count, view_commands);
+				view_commands += batch.mesh->GetLodCount();
+				view_slots += batch.count * batch.mesh->GetLodCount();
+			}
+			m_gpu_view_commands = view_commands;
+
+			// Every command has room for the whole batch, so no command or view can overflow into another
+			m_view_commands.clear();
+			for (uint32_t v = 0; v < view_count; ++v) {
+				uint32_t base_instance = v * view_slots;
+				for (const RenderBatch& batch : batches) {
+					for (uint32_t lod = 0; lod < batch.mesh->GetLodCount(); ++lod) {
+						m_view_commands.push_back(batch.mesh->MakeDrawCommand(0, base_instance, lod));
+						base_instance += batch.count;
+					}
+				}
+			}
+
+			EnsureCapacity(m_instance_batches, instance_count, sizeof(uint32_t));
+			EnsureCapacity(m_gpu_command_template, view_count * view_commands, sizeof(DrawElementsIndirectCommand));
+			EnsureCapacity(m_gpu_commands, view_count * view_commands, sizeof(DrawElementsIndirectCommand));
+			EnsureCapacity(m_gpu_visible, view_count * view_slots, sizeof(uint32_t));
+
+			StageUpload(m_instance_batches.buffer, 0, batch_commands.data(), instance_count * sizeof(uint32_t));
+			StageUpload(m_gpu_command_template.buffer, 0, m_view_commands.data(),
+						m_view_commands.size() * sizeof(DrawElementsIndirectCommand));
+		}
+
+		// Reset this frame's commands and counters
+		const uint32_t view_commands = m_gpu_view_commands;
+		const GLsizeiptr command_bytes = static_cast<GLsizeiptr>(view_count * view_commands * sizeof(DrawElementsIndirectCommand));
+		glBindBuffer(GL_COPY_READ_BUFFER, m_gpu_command_template.buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_gpu_commands.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, command_bytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		std::fill_n(m_cull_counters_mapped + counter_offset, k_cull_counter_stride, 0u);
+
+		auto cull_shader = ShaderManager::GetOrCreateComputeShader(RESOURCES_PATH "shaders/cull.comp");
+		cull_shader->Bind();
+		cull_shader->SetUniform1ui("instance_count", instance_count);
+		cull_shader->SetUniform1ui("command_count", view_commands);
+		cull_shader->SetUniform1ui("view_count", view_count);
+		cull_shader->SetUniform1ui("counter_offset", counter_offset);
+
+		// The pyramid holds last frame's depth, so bounds are projected with last frame's camera
+		const bool occlusion = m_occlusion_culling && m_hiz.valid;
+		cull_shader->SetUniform1i("occlusion_culling", occlusion ? 1 : 0);
+		if (occlusion) {
+			GLState::BindTexture(k_hiz_texture_unit, GL_TEXTURE_2D, m_hiz.texture);
+			cull_shader->SetUniform1i("hiz", static_cast<int>(k_hiz_texture_unit));
+			cull_shader->SetUniformMat4("hiz_view_projection", m_hiz.view_projection);
+			cull_shader->SetUniform2i("hiz_size", m_hiz.view_width, m_hiz.view_height);
+			cull_shader->SetUniform1i("hiz_levels", m_hiz.levels);
+		}
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_bounds_binding, m_instance_bounds.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_batches_binding, m_instance_batches.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_commands_binding, m_gpu_commands.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_visible_binding, m_gpu_visible.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_counters_binding, m_cull_counters);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_cull_lods_binding, m_instance_lods.buffer);
+
+		glDispatchCompute((instance_count + k_cull_group_size - 1) / k_cull_group_size, 1, 1);
+
+		// Commands and indices are consumed by the draws; counters by the CPU a few frames from now
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+		Shader::Unbind();
+
+		// The passes see the same layout as the CPU path: shadow views first, then per-material buckets
+		m_scene.index_buffer = m_gpu_visible.buffer;
+		m_scene.command_buffer = m_gpu_commands.buffer;
+		m_scene.command_offset = 0;
+
+		// Batches are sorted by geometry layout first, so each layout is one run of every view's commands
+		std::array<uint32_t, k_geometry_layout_count> layout_commands{};
+		uint32_t command = 0;
+		for (const RenderBatch& batch : batches) {
+			const uint32_t lod_count = batch.mesh->GetLodCount();
+			const uint32_t layout = batch.mesh->GetGeometryLayout();
+			if (Material* material = batch.material) {
+				// Atlased materials with a common binding share a bucket
+				if (m_scene.opaque.empty() || m_scene.opaque.back().material->GetBatchKey() != material->GetBatchKey() ||
+					m_scene.opaque.back().layout != layout)
+					m_scene.opaque.push_back({ material, command, 0, 0, layout });
+				m_scene.opaque.back().command_count += lod_count;
+			}
+			layout_commands[layout] += lod_count;
+			command += lod_count;
+		}
+
+		for (uint32_t c = 0; c < cascades; ++c)
+			m_scene.shadow_cascades[c] = { (1 + c) * view_commands, view_commands, 0, layout_commands };
+	}
+
+	void Renderer::SortFrontToBack(std::vector<uint32_t>& visible)
+	{
+		if (visible.size() < 2) return;
+
+		const auto& batches = m_render_list->GetBatches();
+		const CullBounds& bounds = m_render_list->GetWorldBounds();
+		const glm::vec3 eye = m_camera->GetPosition();
+		const glm::vec3 forward = m_camera->GetForwardVector();
+		const float near_plane = m_camera->GetNearPlane();
+		const float far_plane = m_camera->GetFarPlane();
+
+		// Visible slots come out of the cull ascending, so the batch ordinal only ever moves forward
+		m_depth_sort_items.resize(visible.size());
+		uint32_t batch = 0;
+		for (size_t i = 0; i < visible.size(); ++i) {
+			const uint32_t slot = visible[i];
+			while (slot >= batches[batch].first + batches[batch].count) ++batch;
+
+			const glm::vec3 center(bounds.center_x[slot], bounds.center_y[slot], bounds.center_z[slot]);
+			const float depth = glm::dot(center - eye, forward);
+			m_depth_sort_items[i] = { DrawKey::PackInstance(batch, DrawKey::QuantiseDepth(depth, near_plane, far_plane)), slot };
+		}
+
+		RadixSort(m_depth_sort_items, m_depth_sort_scratch);
+		for (size_t i = 0; i < visible.size(); ++i)
+			visible[i] = m_depth_sort_items[i].index;
+	}
+
+	PassDraws Renderer::AppendViewDraws(const std::vector<uint32_t>& visible, const bool lit_only)
+	{
+		PassDraws pass{ static_cast<uint32_t>(m_view_commands.size()), 0, 0 };
+		const auto& lods = m_render_list->GetLods();
+
+		// Visible slots are grouped in batch order (ascending, or depth-sorted within each batch),
+		// so one forward walk splits one by the other
+		size_t v = 0;
+		for (const RenderBatch& batch : m_render_list->GetBatches()) {
+			const uint32_t end = batch.first + batch.count;
+			const size_t batch_begin = v;
+			while (v < visible.size() && visible[v] < end) ++v;
+			if (lit_only && !batch.material) continue;
+
+			// One command per LOD in use; each keeps the batch's depth order
+			for (uint32_t lod = 0; lod < batch.mesh->GetLodCount(); ++lod) {
+				const auto first_index = static_cast<uint32_t>(m_view_indices.size());
+				for (size_t k = batch_begin; k < v; ++k)
+					if (lods[visible[k]] == lod) m_view_indices.push_back(visible[k]);
+
+				const auto count = static_cast<uint32_t>(m_view_indices.size()) - first_index;
+				if (count == 0) continue;
+
+				const uint32_t layout = batch.mesh->GetGeometryLayout();
+				if (lit_only && (m_scene.opaque.empty() || m_scene.opaque.back().material->GetBatchKey() != batch.material->GetBatchKey() ||
+								 m_scene.opaque.back().layout != layout))
+					m_scene.opaque.push_back({ batch.material, static_cast<uint32_t>(m_view_commands.size()), 0, 0, layout });
+
+				// Close instances of big meshes skip the meshlets they can't see; wireframe shows hidden back faces too
+				if (lit_only && lod == 0 && m_meshlet_culling && !m_wireframe_mode && !batch.mesh->meshlets.empty()) {
+					AppendMeshletDraws(batch, first_index, pass);
+					continue;
+				}
+
+				m_view_commands.push_back(batch.mesh->MakeDrawCommand(count, first_index, lod));
+				++pass.command_count;
+				++pass.layout_commands[layout];
+				pass.instance_count += count;
+
+				if (lit_only) {
+					++m_scene.opaque.back().command_count;
+					m_scene.opaque.back().instance_count += count;
+				}
+			}
+		}
+
+		return pass;
+	}
+
+	void Renderer::AppendMeshletDraws(const RenderBatch& batch, const uint32_t first_index, PassDraws& pass)
+	{
+		const Mesh& mesh = *batch.mesh;
+		const auto meshlet_count = static_cast<uint32_t>(mesh.meshlets.size());
+		const auto& transforms = m_render_list->GetTransforms();
+		const glm::vec3 eye = m_camera->GetPosition();
+
+		// Instances were appended as one run; they get regrouped meshlet by meshlet instead
+		m_meshlet_instances.assign(m_view_indices.begin() + first_index, m_view_indices.end());
+		m_view_indices.resize(first_index);
+
+		m_meshlet_pairs.clear();
+		m_meshlet_offsets.assign(meshlet_count + 1, 0);
+		for (const uint32_t slot : m_meshlet_instances) {
+			m_meshlet_visible.clear();
+			MeshletCull(m_camera_frustum, eye, transforms[slot], mesh.meshlets, m_meshlet_visible);
+			for (const uint32_t meshlet : m_meshlet_visible) {
+				m_meshlet_pairs.emplace_back(meshlet, slot);
+				++m_meshlet_offsets[meshlet + 1];
+			}
+			m_render_stats.meshlets_visible += static_cast<uint32_t>(m_meshlet_visible.size());
+			m_render_stats.meshlets_culled += meshlet_count - static_cast<uint32_t>(m_meshlet_visible.size());
+		}
+		for (uint32_t m = 0; m < meshlet_count; ++m)
+			m_meshlet_offsets[m + 1] += m_meshlet_offsets[m];
+
+		// Counting sort by meshlet; stable, so each meshlet's instances keep the batch's depth order
+		m_view_indices.resize(first_index + m_meshlet_pairs.size());
+		m_meshlet_visible.assign(m_meshlet_offsets.begin(), m_meshlet_offsets.end() - 1);
+		for (const auto& [meshlet, slot] : m_meshlet_pairs)
+			m_view_indices[first_index + m_meshlet_visible[meshlet]++] = slot;
+
+		for (uint32_t m = 0; m < meshlet_count; ++m) {
+			const uint32_t count = m_meshlet_offsets[m + 1] - m_meshlet_offsets[m];
+			if (count == 0) continue;
+
+			m_view_commands.push_back(mesh.MakeMeshletCommand(count, first_index + m_meshlet_offsets[m], m));
+			++pass.command_count;
+			++pass.layout_commands[mesh.GetGeometryLayout()];
+			++m_scene.opaque.back().command_count;
+		}
+
+		// Instances, not instance-meshlet pairs, so the metrics stay comparable with whole-mesh draws
+		const auto instances = static_cast<uint32_t>(m_meshlet_instances.size());
+		pass.instance_count += instances;
+		m_scene.opaque.back().instance_count += instances;
+	}
+
+	void Renderer::BindSceneBuffers(const GLuint index_buffer, const GLuint command_buffer) const
+	{
+		// Per-instance attribute is an index into the instance table, which shaders read as an SSBO.
+		// Every layout's VAO reads it; passes switch between them per multi-draw.
+		for (uint32_t layout = k_geometry_layout_count; layout-- > 0;) {
+			GeometryPool::Get()->Bind(layout);
+			glBindVertexBuffer(Mesh::k_instance_binding, index_buffer, 0, sizeof(uint32_t));
+		}
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_instance_table_binding, m_instance_table.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_instance_decode_binding, m_instance_decode.buffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	}
+
+	bool Renderer::EnsureCapacity(GpuBuffer& buffer, const uint32_t count, const GLsizeiptr stride)
+	{
+		if (buffer.buffer && count <= buffer.capacity) return false;
+
+		// Contents are not preserved; callers re-upload everything after a grow
+		const uint32_t capacity = std::max({ count, buffer.capacity * 2, 64u });
+		if (buffer.buffer) glDeleteBuffers(1, &buffer.buffer);
+
+		glGenBuffers(1, &buffer.buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.buffer);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, capacity * stride, nullptr, 0); // only ever written by copies
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		buffer.capacity = capacity;
+		return true;
+	}
+
+	void Renderer::StageUpload(const GLuint destination, const GLintptr offset, const void* data, const GLsizeiptr size)
+	{
+		// Write into the mapped ring, then let the GPU copy it into place
+		auto staging = m_upload_ring->Allocate(size, 16);
+		std::memcpy(staging.data, data, static_cast<size_t>(size));
+
+		glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staging.offset, offset, size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
 	GLFWwindow* Renderer::GetWindow() const
 	{
 		return m_window.get();
@@ -626,6 +1610,24 @@ namespace Hex
 		return m_camera.get();
 	}
 
+	void Renderer::UpdateDynamicResolution()
+	{
+		DynamicResolution& dr = m_dynamic_resolution;
+		if (!dr.enabled) {
+			dr.scale = 1.0f;
+		} else if (const float scene_ms = m_gpu_profiler->GetLastMilliseconds("Viewport"); scene_ms > 0.0f) {
+			// Viewport passes cost about scale^2; the shadow passes don't scale, so they come off the budget first.
+			// Timings are a few frames old, so only a fraction of the step is taken each frame.
+			const float shadow_ms = m_gpu_profiler->GetLastMilliseconds("Shadow cascades") + m_gpu_profiler->GetLastMilliseconds("Point shadows");
+			const float budget = std::max(dr.target_ms - shadow_ms, dr.target_ms * 0.1f);
+			const float ideal = dr.scale * std::sqrt(budget / scene_ms);
+			dr.scale = std::clamp(dr.scale + (ideal - dr.scale) * dr.response, dr.min_scale, 1.0f);
+		}
+
+		m_frame_buffer.render_width = std::max(1u, static_cast<unsigned int>(std::lround(static_cast<float>(m_frame_buffer.width) * dr.scale)));
+		m_frame_buffer.render_height = std::max(1u, static_cast<unsigned int>(std::lround(static_cast<float>(m_frame_buffer.height) * dr.scale)));
+	}
+
 	void Renderer::UpdateRenderData()
 	{
 		//if(m_render_data == m_old_render_data) return;
@@ -653,11 +1655,223 @@ namespace Hex
 
 		m_render_data.padding4[0]  = m_render_data.padding4[1] = m_render_data.padding4[2] = 0.0f;
 
+		// Frustum planes for culling, on the CPU and in cull.comp
+		m_camera_frustum = m_camera->GetFrustum();
+		for (int p = 0; p < 6; ++p)
+			m_render_data.frustum_planes[p] = m_camera_frustum.planes[p];
+		for (int c = 0; c < k_max_shadow_cascades; ++c)
+			for (int p = 0; p < 6; ++p)
+				m_render_data.cascade_planes[c * 6 + p] = m_shadow_map.caster_frustums[c].planes[p];
+
+		// Shadow lookup data for the lit pass; no cascades when the shadow pass is skipped
+		m_render_data.cascade_count = m_wireframe_mode ? 0 : m_shadow_map.cascade_count;
+		for (int c = 0; c < k_max_shadow_cascades; ++c) {
+			m_render_data.light_space_matrices[c] = m_shadow_map.light_projection[c] * m_shadow_map.light_view[c];
+			m_render_data.cascade_splits[c] = m_shadow_map.split_depths[c];
+		}
+		m_render_data.padding5[0] = m_render_data.padding5[1] = m_render_data.padding5[2] = 0;
+
+		// Cluster lookup for the lit pass: pixel -> tile, view depth -> logarithmic slice
+		m_light_grid.SetProjection(m_camera->GetFieldOfView(), m_camera->GetAspectRatio(),
+								   m_camera->GetNearPlane(), m_camera->GetFarPlane(), m_light_grid_far);
+		m_render_data.cluster_grid = { LightGrid::k_tiles_x, LightGrid::k_tiles_y, LightGrid::k_slices };
+		m_render_data.padding6 = 0;
+		m_render_data.cluster_params = {
+			static_cast<float>(LightGrid::k_tiles_x) / static_cast<float>(m_frame_buffer.render_width),
+			static_cast<float>(LightGrid::k_tiles_y) / static_cast<float>(m_frame_buffer.render_height),
+			m_light_grid.GetSliceScale(),
+			m_light_grid.GetSliceBias()
+		};
+
 		glBindBuffer(GL_UNIFORM_BUFFER, m_uboRenderData);
 		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(RenderData), &m_render_data);
 		glBindBuffer(GL_UNIFORM_BUFFER, 0);
 	}
 
+	void Renderer::UpdateLights()
+	{
+		HEX_PROFILE_SCOPE("Renderer::UpdateLights");
+		const auto start = std::chrono::steady_clock::now();
+
+		// Position (and spot direction) come from the transform; colour is premultiplied by intensity
+		m_lights.clear();
+		m_shadow_candidates.clear();
+		const glm::vec3 eye = m_camera->GetPosition();
+		for (auto [entity, transform, light] : m_registry.view<TransformComponent, PointLightComponent>().each()) {
+			if (light.cast_shadows && m_point_shadows_enabled) {
+				const glm::vec3 offset = transform.position - eye;
+				m_shadow_candidates.push_back({ glm::dot(offset, offset), static_cast<uint32_t>(m_lights.size()), entt::to_integral(entity) });
+			}
+			m_lights.push_back({ transform.position, light.range, light.color * light.intensity, 0.0f, glm::vec3(0.0f), 1.0f, -1 });
+		}
+		m_point_light_count = static_cast<uint32_t>(m_lights.size());
+
+		for (auto [entity, transform, light] : m_registry.view<TransformComponent, SpotLightComponent>().each()) {
+			const float cos_outer = std::cos(glm::radians(light.outer_angle));
+			const float cos_inner = std::max(std::cos(glm::radians(light.inner_angle)), cos_outer + 1e-4f);
+			const float spot_scale = 1.0f / (cos_inner - cos_outer);
+			const glm::vec3 direction = glm::normalize(transform.orientation * glm::vec3(0.0f, 0.0f, -1.0f));
+			m_lights.push_back({ transform.position, light.range, light.color * light.intensity, spot_scale,
+								 direction, -cos_outer * spot_scale, -1 });
+		}
+		m_spot_light_count = static_cast<uint32_t>(m_lights.size()) - m_point_light_count;
+		AssignPointShadows();
+
+		// Spot lights are assigned by their whole sphere; the cone term zeroes what lies outside it
+		m_light_grid.Assign(m_lights, m_render_data.view);
+
+		// debug.frag always reads the cluster table, so it exists even with no lights; the others are never indexed then
+		const std::vector<glm::uvec2>& clusters = m_light_grid.GetClusters();
+		const std::vector<uint32_t>& indices = m_light_grid.GetLightIndices();
+		EnsureCapacity(m_light_cluster_buffer, LightGrid::k_cluster_count, sizeof(glm::uvec2));
+		EnsureCapacity(m_light_buffer, static_cast<uint32_t>(m_lights.size()), sizeof(GpuLight));
+		EnsureCapacity(m_light_index_buffer, static_cast<uint32_t>(indices.size()), sizeof(uint32_t));
+
+		StageUpload(m_light_cluster_buffer.buffer, 0, clusters.data(), static_cast<GLsizeiptr>(clusters.size() * sizeof(glm::uvec2)));
+		if (!m_lights.empty())
+			StageUpload(m_light_buffer.buffer, 0, m_lights.data(), static_cast<GLsizeiptr>(m_lights.size() * sizeof(GpuLight)));
+		if (!indices.empty())
+			StageUpload(m_light_index_buffer.buffer, 0, indices.data(), static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)));
+		m_light_buffer.count = static_cast<uint32_t>(m_lights.size());
+		m_light_index_buffer.count = static_cast<uint32_t>(indices.size());
+
+		m_render_stats.lights = static_cast<uint32_t>(m_lights.size());
+		m_render_stats.light_clusters = m_light_grid.GetActiveClusters();
+		m_render_stats.light_assignments = static_cast<uint32_t>(indices.size());
+		m_render_stats.max_cluster_lights = m_light_grid.GetMaxClusterLights();
+		m_render_stats.light_assign_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Renderer::AssignPointShadows()
+	{
+		// The nearest shadow-casting point lights get a cube; a light keeps its slot (and cached depth) while it stays in the set
+		const size_t count = std::min<size_t>(m_shadow_candidates.size(), k_max_point_shadows);
+		std::partial_sort(m_shadow_candidates.begin(), m_shadow_candidates.begin() + static_cast<std::ptrdiff_t>(count), m_shadow_candidates.end(),
+						  [](const ShadowCandidate& a, const ShadowCandidate& b) { return a.distance2 < b.distance2; });
+
+		for (PointShadowSlot& slot : m_point_shadows.slots) {
+			const auto chosen_end = m_shadow_candidates.begin() + static_cast<std::ptrdiff_t>(count);
+			const bool chosen = std::any_of(m_shadow_candidates.begin(), chosen_end,
+											[&](const ShadowCandidate& candidate) { return candidate.entity == slot.light; });
+			if (!chosen) slot = {};
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			const ShadowCandidate& candidate = m_shadow_candidates[i];
+			auto it = std::find_if(m_point_shadows.slots.begin(), m_point_shadows.slots.end(),
+								   [&](const PointShadowSlot& slot) { return slot.light == candidate.entity; });
+			if (it == m_point_shadows.slots.end())
+				it = std::find_if(m_point_shadows.slots.begin(), m_point_shadows.slots.end(),
+								  [](const PointShadowSlot& slot) { return slot.light == ~0u; });
+
+			const auto s = static_cast<uint32_t>(it - m_point_shadows.slots.begin());
+			PointShadowSlot& slot = *it;
+			GpuLight& light = m_lights[candidate.light];
+			light.shadow_index = static_cast<int32_t>(s);
+			if (slot.light == candidate.entity && slot.position == light.position && slot.range == light.range) continue;
+
+			// New or moved light: every face starts over
+			slot.light = candidate.entity;
+			slot.position = light.position;
+			slot.range = light.range;
+			slot.static_valid = 0;
+			slot.dynamic_faces = 0;
+
+			static const std::array<std::pair<glm::vec3, glm::vec3>, 6> faces = {{
+				{ { 1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+				{ {-1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+				{ { 0.0f,  1.0f,  0.0f }, { 0.0f,  0.0f,  1.0f } },
+				{ { 0.0f, -1.0f,  0.0f }, { 0.0f,  0.0f, -1.0f } },
+				{ { 0.0f,  0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f } },
+				{ { 0.0f,  0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f } },
+			}};
+			const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, k_point_shadow_near, light.range);
+			for (int f = 0; f < 6; ++f) {
+				slot.face_matrices[f] = projection * glm::lookAt(light.position, light.position + faces[f].first, faces[f].second);
+				slot.face_frustums[f] = Frustum::FromMatrix(slot.face_matrices[f]);
+			}
+		}
+	}
+
+	void Renderer::UpdatePointShadows()
+	{
+		HEX_PROFILE_SCOPE("Renderer::UpdatePointShadows");
+		m_render_stats.point_shadow_faces_static = 0;
+		m_render_stats.point_shadow_faces_dynamic = 0;
+		m_render_stats.point_shadow_faces_cached = 0;
+		for (PointShadowSlot& slot : m_point_shadows.slots) {
+			slot.static_redraw = 0;
+			slot.live_redraw = 0;
+			slot.static_casters = {};
+			slot.dynamic_casters = {};
+		}
+
+		// Static depth goes stale when the list was rebuilt, or a static caster moved across a face or
+		// switched LOD on it
+		const CullBounds& moved = m_render_list->GetMovedStaticBounds();
+		const CullBounds& relodded = m_render_list->GetLodChangedStaticBounds();
+		for (PointShadowSlot& slot : m_point_shadows.slots) {
+			if (slot.light == ~0u) continue;
+			if (m_render_list->WasRebuilt()) {
+				slot.static_valid = 0;
+				continue;
+			}
+			for (const CullBounds* stale : { &moved, &relodded })
+				for (uint32_t i = 0; i < stale->center_x.size(); ++i)
+					for (int f = 0; f < 6; ++f)
+						if (IsVisible(slot.face_frustums[f], *stale, i)) slot.static_valid &= static_cast<uint8_t>(~(1u << f));
+		}
+
+		if (m_wireframe_mode) return;
+
+		m_view_indices.clear();
+		m_view_commands.clear();
+		const CullBounds& bounds = m_render_list->GetWorldBounds();
+		const auto& dynamic = m_render_list->GetDynamic();
+		const uint32_t instance_count = m_scene.instance_count;
+
+		for (PointShadowSlot& slot : m_point_shadows.slots) {
+			if (slot.light == ~0u) continue;
+
+			// Casters within the light's range, split by whether their depth can be cached
+			Frustum sphere_box;
+			const glm::vec3& p = slot.position;
+			const float r = slot.range;
+			sphere_box.planes = {
+				glm::vec4( 1.0f, 0.0f, 0.0f, r - p.x), glm::vec4(-1.0f, 0.0f, 0.0f, r + p.x),
+				glm::vec4(0.0f,  1.0f, 0.0f, r - p.y), glm::vec4(0.0f, -1.0f, 0.0f, r + p.y),
+				glm::vec4(0.0f, 0.0f,  1.0f, r - p.z), glm::vec4(0.0f, 0.0f, -1.0f, r + p.z),
+			};
+			m_shadow_visible.clear();
+			FrustumCull(sphere_box, bounds, 0, instance_count, m_shadow_visible);
+
+			m_static_casters.clear();
+			m_dynamic_casters.clear();
+			for (const uint32_t slot_index : m_shadow_visible)
+				(dynamic[slot_index] ? m_dynamic_casters : m_static_casters).push_back(slot_index);
+
+			uint8_t dynamic_now = 0;
+			for (const uint32_t i : m_dynamic_casters)
+				for (int f = 0; f < 6; ++f)
+					if (!(dynamic_now & (1u << f)) && IsVisible(slot.face_frustums[f], bounds, i)) dynamic_now |= static_cast<uint8_t>(1u << f);
+
+			// Faces with dynamic casters now or last frame are rebuilt from the static depth, which itself is
+			// only redrawn where it is stale
+			slot.static_redraw = static_cast<uint8_t>(~slot.static_valid & 0x3F);
+			slot.live_redraw = static_cast<uint8_t>(slot.static_redraw | dynamic_now | slot.dynamic_faces);
+			slot.dynamic_faces = dynamic_now;
+
+			if (slot.static_redraw) slot.static_casters = AppendViewDraws(m_static_casters, false);
+			if (dynamic_now) slot.dynamic_casters = AppendViewDraws(m_dynamic_casters, false);
+
+			m_render_stats.point_shadow_faces_static += static_cast<uint32_t>(std::popcount(slot.static_redraw));
+			m_render_stats.point_shadow_faces_dynamic += static_cast<uint32_t>(std::popcount(slot.live_redraw));
+			m_render_stats.point_shadow_faces_cached += 6 - static_cast<uint32_t>(std::popcount(slot.live_redraw));
+		}
+
+		UploadViewDraws(m_point_shadow_draws, m_point_shadow_command_offset);
+	}
+
 	void Renderer::SetLightDir(const glm::vec3 &dir)
 	{
 		m_light_dir = dir;
@@ -676,10 +1890,15 @@ namespace Hex
 
 	void Renderer::EndImGuiFrame(const float& delta_time)
 	{
+		HEX_PROFILE_SCOPE("Renderer::EndImGuiFrame");
 		// Render ImGui
 		ImGui::Render();
 
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		// Timed in the main context only; queries don't carry over to the platform windows' contexts
+		{
+			GpuProfiler::Scope gpu_zone(*m_gpu_profiler, "ImGui");
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
 
 		// Handle multi-viewports
 		ImGuiIO& io = ImGui::GetIO();
@@ -697,8 +1916,70 @@ namespace Hex
 		}
 	}
 
+#if !PRODUCTION_BUILD
+	void Renderer::ShowCpuProfiler()
+	{
+		Profiler& profiler = Profiler::Get();
+		const Profiler::Frame& frame = profiler.GetLastFrame();
+		const double frame_ns = static_cast<double>(std::max<uint64_t>(frame.end_ns - frame.begin_ns, 1));
+
+		ImGui::Checkbox("Pause", &profiler.paused);
+		ImGui::SameLine();
+		if (ImGui::Button("Save Chrome trace"))
+		{
+			constexpr const char* path = "cpu_trace.json";
+			if (profiler.WriteChromeTrace(path))
+				Log(LogLevel::Info, std::format("CPU trace written to {} (open in chrome://tracing or Perfetto)", path));
+			else
+				Log(LogLevel::Error, std::format("Could not write CPU trace to {}", path));
+		}
+		ImGui::Text("Frame: %.3f ms, %zu zones, %llu events lost", frame_ns * 1e-6, frame.events.size(),
+					static_cast<unsigned long long>(profiler.GetLostEvents()));
+		ImGui::Separator();
+
+		// One flame graph per thread: x is time across the frame, y is nesting depth
+		const std::vector<std::string> thread_names = profiler.GetThreadNames();
+		const float row_height = ImGui::GetTextLineHeightWithSpacing();
+		for (uint32_t thread = 0; thread < thread_names.size(); ++thread)
+		{
+			uint32_t rows = 0;
+			for (const ProfileEvent& event : frame.events)
+				if (event.thread == thread) rows = std::max(rows, event.depth + 1);
+			if (rows == 0) continue;
+
+			ImGui::TextUnformatted(thread_names[thread].c_str());
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+			ImGui::Dummy(ImVec2(width, row_height * static_cast<float>(rows)));
+			ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+			for (const ProfileEvent& event : frame.events)
+			{
+				if (event.thread != thread) continue;
+
+				// Worker zones may straddle the frame's edges
+				const auto clamp_x = [&](const uint64_t ns) {
+					const double t = (static_cast<double>(ns) - static_cast<double>(frame.begin_ns)) / frame_ns;
+					return origin.x + width * static_cast<float>(std::clamp(t, 0.0, 1.0));
+				};
+				const ImVec2 min(clamp_x(event.begin_ns), origin.y + row_height * static_cast<float>(event.depth));
+				const ImVec2 max(std::max(clamp_x(event.end_ns), min.x + 1.0f), min.y + row_height - 1.0f);
+
+				const float hue = static_cast<float>(std::hash<std::string_view>{}(event.name) % 360u) / 360.0f;
+				draw_list->AddRectFilled(min, max, ImColor::HSV(hue, 0.45f, 0.65f));
+				if (ImGui::CalcTextSize(event.name).x < max.x - min.x - 4.0f)
+					draw_list->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, event.name);
+
+				if (ImGui::IsMouseHoveringRect(min, max))
+					ImGui::SetTooltip("%s: %.3f ms", event.name, static_cast<double>(event.end_ns - event.begin_ns) * 1e-6);
+			}
+		}
+	}
+#endif
+
 	void Renderer::ShowDebugUI(const float& delta_time)
 	{
+		HEX_PROFILE_SCOPE("Renderer::ShowDebugUI");
 		// Start the main menu bar
 		if (ImGui::BeginMainMenuBar())
 		{
@@ -715,7 +1996,12 @@ namespace Hex
 				ImGui::MenuItem("Rendering Metrics", nullptr, &m_show_metrics);
 				ImGui::MenuItem("Scene Information", nullptr, &m_show_scene_info);
 				ImGui::MenuItem("Lighting Tool", nullptr, &m_show_lighting_tool);
+				ImGui::MenuItem("GPU Profiler", nullptr, &m_show_gpu_profiler);
+#if !PRODUCTION_BUILD
+				ImGui::MenuItem("CPU Profiler", nullptr, &m_show_cpu_profiler);
+#endif
 				ImGui::MenuItem("Wireframe", nullptr, &m_wireframe_mode);
+				ImGui::MenuItem("Depth Pre-pass", nullptr, &m_depth_prepass);
 
 				if (m_wireframe_mode)
 				{
@@ -738,10 +2024,130 @@ namespace Hex
 			{
 				ImGui::Text("FPS: %.1f", 1.0f / delta_time);
 				ImGui::Text("Frame-time: %.6f ms", delta_time * 1000.0f);
+				ImGui::Separator();
+
+				ImGui::Text("Draw calls: %u (%u indirect commands)", m_render_stats.draw_calls, m_render_stats.draw_commands);
+				ImGui::Text("Instances drawn: %u", m_render_stats.instances);
+				const GLStateStats& gl_state = GLState::GetStats();
+				ImGui::Text("GL state calls: %u issued, %u skipped", gl_state.state_issued, gl_state.state_skipped);
+				ImGui::Text("Uniform uploads: %u issued, %u skipped", gl_state.uniforms_issued, gl_state.uniforms_skipped);
+				ImGui::Text("Render list: %zu proxies in %zu batches",
+							m_render_list->GetProxies().size(), m_render_list->GetBatches().size());
+				ImGui::Text("Re-sorted: %u, transforms updated: %u",
+							m_render_stats.proxies_resorted, m_render_stats.transforms_updated);
+				ImGui::Checkbox("GPU culling", &m_gpu_culling);
+				ImGui::BeginDisabled(m_gpu_culling);
+				ImGui::Checkbox("Front-to-back instances", &m_front_to_back);
+				ImGui::Checkbox("Meshlet culling (LOD 0)", &m_meshlet_culling);
+				ImGui::EndDisabled();
+				ImGui::BeginDisabled(!m_gpu_culling);
+				ImGui::Checkbox("Occlusion culling (Hi-Z)", &m_occlusion_culling);
+				ImGui::EndDisabled();
+				ImGui::Text("Frustum culling (%s): %u visible, %u culled",
+							m_gpu_culling ? "compute" : GetCullingInstructionSet(), m_render_stats.visible, m_render_stats.culled);
+				if (m_gpu_culling && m_occlusion_culling)
+					ImGui::Text("Occlusion culling: %u rejected (%d Hi-Z levels)", m_render_stats.occluded, m_hiz.levels);
+				ImGui::Text("Shadow casters: %u drawn, %u culled (all cascades)",
+							m_render_stats.shadow_visible, m_render_stats.shadow_culled);
+				if (!m_gpu_culling && m_meshlet_culling)
+					ImGui::Text("Meshlets: %u drawn, %u culled", m_render_stats.meshlets_visible, m_render_stats.meshlets_culled);
+				ImGui::Text("Light clusters: %u / %u in use, %u assignments (max %u per cluster), %.3f ms",
+							m_render_stats.light_clusters, LightGrid::k_cluster_count, m_render_stats.light_assignments,
+							m_render_stats.max_cluster_lights, m_render_stats.light_assign_ms);
+				ImGui::Checkbox("Mesh LODs", &m_lod_selection.enabled);
+				ImGui::BeginDisabled(!m_lod_selection.enabled);
+				ImGui::SliderFloat("LOD hysteresis", &m_lod_selection.hysteresis, 0.0f, 0.5f);
+				ImGui::EndDisabled();
+				ImGui::Text("Proxies per LOD: %u / %u / %u / %u",
+							m_render_stats.lod_proxies[0], m_render_stats.lod_proxies[1],
+							m_render_stats.lod_proxies[2], m_render_stats.lod_proxies[3]);
+				ImGui::Checkbox("Dynamic resolution", &m_dynamic_resolution.enabled);
+				ImGui::BeginDisabled(!m_dynamic_resolution.enabled);
+				ImGui::DragFloat("Target GPU ms", &m_dynamic_resolution.target_ms, 0.1f, 1.0f, 100.0f);
+				ImGui::SliderFloat("Min scale", &m_dynamic_resolution.min_scale, 0.25f, 1.0f);
+				ImGui::EndDisabled();
+				ImGui::Text("Render size: %u x %u of %u x %u (%.0f%%)", m_frame_buffer.render_width, m_frame_buffer.render_height,
+							m_frame_buffer.width, m_frame_buffer.height, m_dynamic_resolution.scale * 100.0f);
+				ImGui::Text("Scene extraction: %.3f ms, %.1f KB uploaded",
+							m_render_stats.extract_ms, static_cast<float>(m_render_stats.instance_bytes) / 1024.0f);
+				if (const GeometryPool* pool = GeometryPool::Get())
+				{
+					ImGui::Text("Geometry pool: %u / %u vertices, %u / %u compact",
+								pool->GetVertexCount(VertexFormat::Standard), pool->GetVertexCapacity(VertexFormat::Standard),
+								pool->GetVertexCount(VertexFormat::Compact), pool->GetVertexCapacity(VertexFormat::Compact));
+					// Every 16-bit index would otherwise take 4 bytes
+					const GLuint short_indices = pool->GetIndexCount(IndexType::UInt16);
+					ImGui::Text("Indices: %u / %u 32-bit, %u / %u 16-bit (%.1f KB saved)",
+								pool->GetIndexCount(IndexType::UInt32), pool->GetIndexCapacity(IndexType::UInt32),
+								short_indices, pool->GetIndexCapacity(IndexType::UInt16),
+								static_cast<float>(short_indices * sizeof(uint16_t)) / 1024.0f);
+				}
+				if (const TextureAtlas* atlas = TextureAtlas::Get())
+				{
+					ImGui::Text("Texture atlas: %zu pages, %u layers, %zu materials",
+								atlas->GetPageCount(), atlas->GetLayerCount(), atlas->GetMaterialCount());
+				}
+				ImGui::Separator();
+
+				const RingBufferStats& ring = m_upload_ring->GetStats();
+				ImGui::Text("Upload: %.1f KB / frame", static_cast<float>(ring.bytes_uploaded) / 1024.0f);
+				ImGui::Text("Upload ring: %.0f KB x %u frames",
+							static_cast<float>(m_upload_ring->GetFrameCapacity()) / 1024.0f, RingBuffer::k_frames_in_flight);
+				ImGui::Text("Ring stalls avoided: %u, stalled: %u, grown: %u, overflowed: %u",
+							ring.stalls_avoided, ring.stalls, ring.reallocations, ring.overflows);
+			}
+			ImGui::End();
+		}
+
+		if (m_show_gpu_profiler)
+		{
+			if (ImGui::Begin("GPU Profiler", &m_show_gpu_profiler))
+			{
+				ImGui::Text("Averages and maxima over the last %u resolved frames, %u frames late (%u dropped)",
+							GpuProfiler::k_history, GpuProfiler::k_latency, m_gpu_profiler->GetDroppedFrames());
+				if (ImGui::BeginTable("gpu_zones", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+				{
+					ImGui::TableSetupColumn("Pass");
+					ImGui::TableSetupColumn("Last (ms)");
+					ImGui::TableSetupColumn("Avg (ms)");
+					ImGui::TableSetupColumn("Max (ms)");
+					ImGui::TableHeadersRow();
+					for (const GpuProfiler::Zone& zone : m_gpu_profiler->GetZones())
+					{
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						const float indent = static_cast<float>(zone.depth) * 12.0f;
+						if (indent > 0.0f) ImGui::Indent(indent); // 0 would mean the default indent
+						ImGui::TextUnformatted(zone.name.c_str());
+						if (indent > 0.0f) ImGui::Unindent(indent);
+						ImGui::TableNextColumn(); ImGui::Text("%.3f", zone.last_ms);
+						ImGui::TableNextColumn(); ImGui::Text("%.3f", zone.average_ms);
+						ImGui::TableNextColumn(); ImGui::Text("%.3f", zone.max_ms);
+					}
+					ImGui::EndTable();
+				}
+
+				if (ImGui::Button("Dump CSV"))
+				{
+					constexpr const char* path = "gpu_profile.csv";
+					if (m_gpu_profiler->WriteCsv(path))
+						Log(LogLevel::Info, std::format("GPU profile written to {}", path));
+					else
+						Log(LogLevel::Error, std::format("Could not write GPU profile to {}", path));
+				}
 			}
 			ImGui::End();
 		}
 
+#if !PRODUCTION_BUILD
+		if (m_show_cpu_profiler)
+		{
+			if (ImGui::Begin("CPU Profiler", &m_show_cpu_profiler))
+				ShowCpuProfiler();
+			ImGui::End();
+		}
+#endif
+
 		if (m_show_scene_info)
 		{
 			if (ImGui::Begin("Scene Information", &m_show_scene_info))
@@ -783,11 +2189,11 @@ namespace Hex
 		{
 			if (ImGui::Begin("Lighting Tool", &m_show_lighting_tool)) // Allow closing
 			{
-				constexpr int active_lights_count = 1; // TODO: update to reflect actual light count
 				constexpr int selected_light_index = 1; // TODO: update to reflect actual selected light index
 
-				// Display static lighting information
-				ImGui::Text("Active Lights: %d", active_lights_count);
+				// The directional light plus every clustered one
+				ImGui::Text("Active Lights: %u (1 directional, %u point, %u spot)",
+							1 + m_point_light_count + m_spot_light_count, m_point_light_count, m_spot_light_count);
 				ImGui::Text("Selected Light: %d", selected_light_index);
 				ImGui::Text("Light Direction:");
 
@@ -802,10 +2208,32 @@ namespace Hex
 				// Shadow Mapping
 				if (ImGui::CollapsingHeader("Shadow Mapping"))
 				{
+					ImGui::Checkbox("Cascaded shadow maps", &m_cascaded_shadows);
+					ImGui::BeginDisabled(m_gpu_culling);
+					ImGui::Checkbox("Cache static casters", &m_shadow_caching);
+					ImGui::EndDisabled();
+					ImGui::Text("Shadow pass: %.3f ms GPU, %.3f ms CPU, %u casters drawn",
+								m_gpu_profiler->GetLastMilliseconds("Shadow cascades"), m_render_stats.shadow_ms, m_render_stats.shadow_visible);
+					if (m_shadow_caching && !m_gpu_culling)
+						ImGui::Text("Cascades: %u static redrawn, %u cached", m_render_stats.shadow_cascades_static,
+									m_render_stats.shadow_cascades_cached);
+					if (m_cascaded_shadows)
+					{
+						ImGui::SliderInt("Cascades", &m_cascade_count, 1, k_max_shadow_cascades);
+						ImGui::DragFloat("Shadow distance", &m_shadow_distance, 1.0f, 1.0f, 1000.0f);
+						ImGui::SliderFloat("Split lambda", &m_cascade_split_lambda, 0.0f, 1.0f);
+						for (int c = 0; c < m_shadow_map.cascade_count; ++c)
+							ImGui::Text("Cascade %d: to %.1f, %u casters", c, m_shadow_map.split_depths[c],
+										m_scene.shadow_cascades[c].instance_count);
+					}
+					ImGui::Separator();
+
 					static float shadow_zoom = 1.0f; // Zoom factor
 					static glm::vec2 shadow_pan(0.0f, 0.0f); // Pan offsets
 
 					ImGui::Text("Shadow Map");
+					m_shadow_preview_cascade = glm::clamp(m_shadow_preview_cascade, 0, m_shadow_map.cascade_count - 1);
+					ImGui::SliderInt("Preview cascade", &m_shadow_preview_cascade, 0, m_shadow_map.cascade_count - 1);
 
 					// Add controls for zoom and pan
 					ImGui::SliderFloat("Zoom", &shadow_zoom, 0.1f, 5.0f, "Zoom: %.2f");
@@ -824,7 +2252,23 @@ namespace Hex
 
 					// Display the shadow map with the calculated UVs
 					ImVec2 image_size(300, 300); // Fixed display size
-					ImGui::Image((void*)(intptr_t)m_shadow_map.texture, image_size, uv_min, uv_max);
+					ImGui::Image((void*)(intptr_t)m_shadow_map.layer_views[m_shadow_preview_cascade], image_size, uv_min, uv_max);
+				}
+
+				if (ImGui::CollapsingHeader("Clustered Lights"))
+				{
+					ImGui::Text("Grid: %u x %u tiles x %u slices", LightGrid::k_tiles_x, LightGrid::k_tiles_y, LightGrid::k_slices);
+					ImGui::DragFloat("Slice distance", &m_light_grid_far, 1.0f, 10.0f, 2000.0f);
+				}
+
+				if (ImGui::CollapsingHeader("Point Light Shadows"))
+				{
+					ImGui::Checkbox("Enable", &m_point_shadows_enabled);
+					ImGui::Text("Cubes: %u max, %d x %d per face", k_max_point_shadows, m_point_shadows.size, m_point_shadows.size);
+					ImGui::Text("Faces: %u static redrawn, %u rebuilt, %u cached",
+								m_render_stats.point_shadow_faces_static,
+								m_render_stats.point_shadow_faces_dynamic,
+								m_render_stats.point_shadow_faces_cached);
 				}
 
 
@@ -840,19 +2284,24 @@ namespace Hex
 		int newWidth = static_cast<int>(viewportPanelSize.x);
 		int newHeight = static_cast<int>(viewportPanelSize.y);
 
-		// Resize framebuffer if dimensions change
+		// Resize framebuffer if dimensions change; the render size follows next frame
 		if (newWidth > 0 && newHeight > 0 &&
-			(newWidth != m_frame_buffer.render_width || newHeight != m_frame_buffer.render_height))
+			(newWidth != m_frame_buffer.width || newHeight != m_frame_buffer.height))
 		{
-			m_frame_buffer.render_width = newWidth;
-			m_frame_buffer.render_height = newHeight;
-			InitFrameBuffer(m_frame_buffer.render_width, m_frame_buffer.render_height);
+			InitFrameBuffer(newWidth, newHeight);
 		}
 
-		// Display the framebuffer texture in ImGui
+		// Display the rendered part of the framebuffer texture in ImGui, stretched to the panel by its
+		// bilinear filter. Scaled down, the far edges stop half a texel short of the unused texels.
+		const float width = static_cast<float>(m_frame_buffer.width);
+		const float height = static_cast<float>(m_frame_buffer.height);
+		const bool scaled = m_frame_buffer.render_width != m_frame_buffer.width || m_frame_buffer.render_height != m_frame_buffer.height;
+		const float inset = scaled ? 0.5f : 0.0f;
+		const float u_max = (static_cast<float>(m_frame_buffer.render_width) - inset) / width;
+		const float v_max = (static_cast<float>(m_frame_buffer.render_height) - inset) / height;
 		ImGui::Image((void*)(intptr_t)m_frame_buffer.texture,
-					 ImVec2(static_cast<float>(m_frame_buffer.render_width), static_cast<float>(m_frame_buffer.render_height)),
-					 ImVec2(0, 1), ImVec2(1, 0));
+					 ImVec2(width, height),
+					 ImVec2(0, v_max), ImVec2(u_max, 0));
 		ImGui::End();
 	}
 }
@@ -3,6 +3,7 @@
 //Hex
 #include "Renderer/Shader.h"
 #include "Core/Logger.h"
+#include "Renderer/GLState.h"
 
 //Lib
 #include <glm/glm.hpp>
@@ -14,10 +15,10 @@
 
 namespace Hex
 {
-    Shader::Shader(const std::string& vertex_path, const std::string& fragment_path) {
+    Shader::Shader(const std::string& vertex_path, const std::string& fragment_path, const std::vector<std::string>& defines) {
         // Load and compile shaders
-        const std::string vertex_source = LoadShaderSource(vertex_path);
-        const std::string fragment_source = LoadShaderSource(fragment_path);
+        const std::string vertex_source = InjectDefines(LoadShaderSource(vertex_path), defines);
+        const std::string fragment_source = InjectDefines(LoadShaderSource(fragment_path), defines);
         const GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, vertex_source);
         const GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, fragment_source);
 
@@ -30,17 +31,40 @@ namespace Hex
         glDeleteShader(fragment_shader);
     }
 
+    Shader::Shader(const std::string& vertex_path, const std::string& geometry_path, const std::string& fragment_path) {
+        const GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, LoadShaderSource(vertex_path));
+        const GLuint geometry_shader = CompileShader(GL_GEOMETRY_SHADER, LoadShaderSource(geometry_path));
+        const GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, LoadShaderSource(fragment_path));
+
+        m_program_id = glCreateProgram();
+        LinkProgram(vertex_shader, geometry_shader, fragment_shader);
+
+        glDeleteShader(vertex_shader);
+        glDeleteShader(geometry_shader);
+        glDeleteShader(fragment_shader);
+    }
+
+    Shader::Shader(const std::string& compute_path) {
+        const std::string compute_source = LoadShaderSource(compute_path);
+        const GLuint compute_shader = CompileShader(GL_COMPUTE_SHADER, compute_source);
+
+        m_program_id = glCreateProgram();
+        LinkProgram(compute_shader);
+
+        glDeleteShader(compute_shader);
+    }
+
     Shader::~Shader() {
         //glDeleteProgram(m_program_id);
     }
 
     void Shader::Bind() const {
-        glUseProgram(m_program_id);
+        GLState::UseProgram(m_program_id);
     }
 
     void Shader::Unbind()
     {
-        glUseProgram(0);
+        GLState::UseProgram(0);
     }
 
     GLuint Shader::GetProgramID() const
@@ -48,21 +72,37 @@ namespace Hex
         return m_program_id;
     }
 
-    // Uniform setting functions
+    // Uniform setting functions; values the program already holds are not re-sent
     void Shader::SetUniform1i(const std::string& name, const int value) {
-        glUniform1i(GetUniformLocation(name), value);
+        const GLint loc = GetUniformLocation(name);
+        if (GLState::UniformChanged(m_program_id, loc, &value, sizeof(value))) glUniform1i(loc, value);
+    }
+
+    void Shader::SetUniform1ui(const std::string& name, const GLuint value) {
+        const GLint loc = GetUniformLocation(name);
+        if (GLState::UniformChanged(m_program_id, loc, &value, sizeof(value))) glUniform1ui(loc, value);
     }
 
     void Shader::SetUniform1f(const std::string& name, const float value) {
-        glUniform1f(GetUniformLocation(name), value);
+        const GLint loc = GetUniformLocation(name);
+        if (GLState::UniformChanged(m_program_id, loc, &value, sizeof(value))) glUniform1f(loc, value);
     }
 
     void Shader::SetUniform2f(const std::string& name, const float x, const float y) {
-        glUniform2f(GetUniformLocation(name), x, y);
+        const GLint loc = GetUniformLocation(name);
+        const float value[2] = { x, y };
+        if (GLState::UniformChanged(m_program_id, loc, value, sizeof(value))) glUniform2f(loc, x, y);
+    }
+
+    void Shader::SetUniform2i(const std::string& name, const int x, const int y) {
+        const GLint loc = GetUniformLocation(name);
+        const int value[2] = { x, y };
+        if (GLState::UniformChanged(m_program_id, loc, value, sizeof(value))) glUniform2i(loc, x, y);
     }
 
     void Shader::SetUniformVec3(const std::string& name, const glm::vec3& value) {
-        glUniform3fv(GetUniformLocation(name), 1, &value[0]);
+        const GLint loc = GetUniformLocation(name);
+        if (GLState::UniformChanged(m_program_id, loc, &value[0], sizeof(value))) glUniform3fv(loc, 1, &value[0]);
     }
 
     void Shader::SetUniformMat4(const std::string& name, const glm::mat4& matrix) {
@@ -71,7 +111,7 @@ namespace Hex
             Log(LogLevel::Warning, "Tried to set missing uniform " + name);
             return;
         }
-        glUniformMatrix4fv(loc, 1, GL_FALSE, &matrix[0][0]);
+        if (GLState::UniformChanged(m_program_id, loc, &matrix[0][0], sizeof(matrix))) glUniformMatrix4fv(loc, 1, GL_FALSE, &matrix[0][0]);
     }
 
     // Private utility functions
@@ -90,6 +130,19 @@ namespace Hex
         return buffer.str();
     }
 
+    std::string Shader::InjectDefines(const std::string& source, const std::vector<std::string>& defines) {
+        if (defines.empty()) return source;
+
+        std::string lines;
+        for (const std::string& define : defines) lines += "#define " + define + "\n";
+
+        // #version has to stay the first statement
+        const size_t version = source.find("#version");
+        const size_t line_end = version == std::string::npos ? std::string::npos : source.find('\n', version);
+        if (line_end == std::string::npos) return lines + source;
+        return source.substr(0, line_end + 1) + lines + source.substr(line_end + 1);
+    }
+
     GLuint Shader::CompileShader(const GLenum type, const std::string& source) {
         const GLuint shader = glCreateShader(type);
         const char* src = source.c_str();
@@ -125,6 +178,26 @@ namespace Hex
         }
     }
 
+    void Shader::LinkProgram(const GLuint vertex_shader, const GLuint geometry_shader, const GLuint fragment_shader) const
+    {
+        glAttachShader(m_program_id, geometry_shader);
+        LinkProgram(vertex_shader, fragment_shader);
+    }
+
+    void Shader::LinkProgram(const GLuint compute_shader) const
+    {
+        glAttachShader(m_program_id, compute_shader);
+        glLinkProgram(m_program_id);
+
+        GLint success;
+        glGetProgramiv(m_program_id, GL_LINK_STATUS, &success);
+        if (!success) {
+            char info_log[512];
+            glGetProgramInfoLog(m_program_id, 512, nullptr, info_log);
+            Log(LogLevel::Error, std::format("ERROR::SHADER::PROGRAM::LINKING_FAILED\n{}", info_log));
+        }
+    }
+
     GLint Shader::GetUniformLocation(const std::string& name) {
         // Check cache for location
         if (m_uniform_location_cache.contains(name)) {
@@ -27,4 +27,31 @@ namespace Hex
 		s_shader_cache[key] = shader;
 		return shader;
 	}
+
+	std::shared_ptr<Shader> ShaderManager::GetOrCreateShader(const std::string& vertex_path, const std::string& geometry_path,
+															 const std::string& fragment_path)
+	{
+		const std::string key = vertex_path + "|" + geometry_path + "|" + fragment_path;
+		if (const auto it = s_shader_cache.find(key); it != s_shader_cache.end())
+		{
+			return it->second;
+		}
+
+		auto shader = std::make_shared<Shader>(vertex_path, geometry_path, fragment_path);
+		s_shader_cache[key] = shader;
+		return shader;
+	}
+
+	std::shared_ptr<Shader> ShaderManager::GetOrCreateComputeShader(const std::string& compute_path)
+	{
+		// Compute programs only have one stage, so the path alone is the key
+		if (const auto it = s_shader_cache.find(compute_path); it != s_shader_cache.end())
+		{
+			return it->second;
+		}
+
+		auto shader = std::make_shared<Shader>(compute_path);
+		s_shader_cache[compute_path] = shader;
+		return shader;
+	}
 }
\ No newline at end of file
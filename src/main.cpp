@@ -4,7 +4,7 @@
 #include "Gameplay/EntityComponents.h"
 #include "Gameplay/EntityManager.h"
 
-int main()
+int main(int argc, char** argv)
 {
     Hex::AppSpecification spec;
     spec.name = "Sandbox";
@@ -13,6 +13,15 @@ int main()
     spec.fullscreen = false;
     spec.vsync = false;
 
+    // --headless [frames]: render a fixed number of frames without any UI and log the timing, for benchmarks
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view(argv[i]) != "--headless") continue;
+        spec.headless = true;
+        if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            spec.headless_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+    }
+
     auto scene = [&](Hex::EntityManager& em)
     {
         auto testMat = Hex::ResourceManager::LoadMaterial(
@@ -42,7 +51,8 @@ int main()
                     {2.f, 2.f, 2.f}
                 });
 
-                auto bunnyMesh = Hex::ResourceManager::LoadModel(RESOURCES_PATH "models/bunny.obj");
+                // 400 bunnies: the quantised 20-byte vertices cut their vertex fetch to well under half
+                auto bunnyMesh = Hex::ResourceManager::LoadModel(RESOURCES_PATH "models/bunny.obj", Hex::VertexFormat::Compact);
                 em.AddComponent<Hex::ModelComponent>(
                     e, Hex::ModelComponent{ bunnyMesh }
                 );
@@ -57,6 +67,44 @@ int main()
             }
         }
 
+        // A few hundred small coloured lights over the bunnies, shaded through the cluster grid
+        for (int i = 0; i < 16; i++)
+        {
+            for (int j = 0; j < 16; j++)
+            {
+                auto light = em.CreateEntity("point_light" + std::to_string(i) + "_" + std::to_string(j));
+                em.AddComponent<Hex::TransformComponent>(light, Hex::TransformComponent{
+                    {-5.f + i * 0.65f, glm::linearRand(0.3f, 1.0f), -5.f + j * 0.65f}
+                });
+                em.AddComponent<Hex::PointLightComponent>(light, Hex::PointLightComponent{
+                    glm::linearRand(glm::vec3(0.2f), glm::vec3(1.f)), 2.f, 1.5f
+                });
+            }
+        }
+
+        // Spot lights looking down on the corners of the floor
+        for (const glm::vec2 corner : { glm::vec2{-6.f, -6.f}, glm::vec2{6.f, -6.f}, glm::vec2{-6.f, 6.f}, glm::vec2{6.f, 6.f} })
+        {
+            auto spot = em.CreateEntity("spot_light");
+            em.AddComponent<Hex::TransformComponent>(spot, Hex::TransformComponent{
+                {corner.x, 4.f, corner.y},
+                glm::angleAxis(glm::radians(-90.f), glm::vec3(1.f, 0.f, 0.f))
+            });
+            em.AddComponent<Hex::SpotLightComponent>(spot, Hex::SpotLightComponent{
+                {1.f, 0.9f, 0.7f}, 20.f, 10.f, 15.f, 25.f
+            });
+        }
+
+        // Two brighter point lights among the bunnies that cast cube shadows
+        for (const glm::vec3 position : { glm::vec3{-2.f, 1.5f, -2.f}, glm::vec3{2.f, 1.5f, 2.f} })
+        {
+            auto light = em.CreateEntity("shadow_light");
+            em.AddComponent<Hex::TransformComponent>(light, Hex::TransformComponent{ position });
+            em.AddComponent<Hex::PointLightComponent>(light, Hex::PointLightComponent{
+                {1.f, 0.85f, 0.6f}, 12.f, 6.f, true
+            });
+        }
+
         auto e = em.CreateEntity("floor");
         em.AddComponent<Hex::TransformComponent>(e, Hex::TransformComponent{
             {0.0f, -2.f, 0.0f},